@@ -1,9 +1,12 @@
 QT += core gui
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-QT += webenginewidgets printsupport
+QT += webenginewidgets printsupport concurrent
 
 CONFIG += c++11
 
+# errno is never inspected, this lets the compiler vectorize sqrt in vectormath.cpp
+gcc:QMAKE_CXXFLAGS += -fno-math-errno
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -12,23 +15,43 @@ TARGET = EquationSolverApp
 TEMPLATE = app
 
 SOURCES += \
+    bounds.cpp \
+    compiledequation.cpp \
+    doubledouble.cpp \
     equation.cpp \
     equationparser.cpp \
+    equationsimplifier.cpp \
     equationsolver.cpp \
     main.cpp \
     equationsolverapp.cpp \
+    nodearena.cpp \
+    polynomial.cpp \
     qcustomplot.cpp \
+    taylor.cpp \
     utils.cpp \
-    window.cpp
+    vectormath.cpp \
+    window.cpp \
+    workstealingpool.cpp
 
 HEADERS += \
+    bounds.h \
+    compiledequation.h \
+    doubledouble.h \
+    dual.h \
     equation.h \
     equationparser.h \
+    equationsimplifier.h \
     equationsolver.h \
     equationsolverapp.h \
+    kernel.h \
+    nodearena.h \
+    polynomial.h \
     qcustomplot.h \
+    taylor.h \
     utils.h \
-    window.h
+    vectormath.h \
+    window.h \
+    workstealingpool.h
 
 FORMS += \
     equationsolverapp.ui \
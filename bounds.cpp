@@ -0,0 +1,304 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace math {
+
+namespace {
+const double INF = std::numeric_limits<double>::infinity();
+const double PI = 3.14159265358979311600e+00;
+const double PI_2 = 1.57079632679489655800e+00;
+
+double down(double x, int ulps = 1) {
+    for (int i = 0; i < ulps; i++) {
+        x = std::nextafter(x, -INF);
+    }
+    return x;
+}
+
+double up(double x, int ulps = 1) {
+    for (int i = 0; i < ulps; i++) {
+        x = std::nextafter(x, INF);
+    }
+    return x;
+}
+
+// Libm transcendental functions are not correctly rounded, but stay within one ulp
+#define BOUNDS_LIBM_ULPS 2
+
+// Rounded outward; NaN from inf - inf or inf * 0 of nonempty arguments means the bound is unknown
+Bounds outward(double lo, double hi, int ulps = 1) {
+    lo = std::isnan(lo) ? -INF : down(lo, ulps);
+    hi = std::isnan(hi) ? INF : up(hi, ulps);
+    return Bounds(lo, hi);
+}
+
+// Product where 0 * inf = 0, as a zero endpoint is exact while an infinite one is a limit
+double product(double a, double b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return a * b;
+}
+
+// Whether some point phase + k * period lies in x. Slack makes the answer conservative
+// when rounding of the division is uncertain.
+bool containsPeriodic(const Bounds& x, double phase, double period) {
+    double lo = (x.lo - phase) / period;
+    double hi = (x.hi - phase) / period;
+    double slack = 1e-9 * (1 + std::max(std::abs(lo), std::abs(hi)));
+    return std::ceil(lo - slack) <= std::floor(hi + slack);
+}
+
+// sin and cos, maximum at maxPhase + 2 k pi and minimum at maxPhase + pi + 2 k pi
+Bounds periodic(const Bounds& x, double (*function)(double), double maxPhase) {
+    if (x.isEmpty()) {
+        return x;
+    }
+    if (!std::isfinite(x.lo) || !std::isfinite(x.hi) || x.width() >= 2 * PI) {
+        return Bounds(-1, 1);
+    }
+    double a = function(x.lo);
+    double b = function(x.hi);
+    Bounds result = outward(std::min(a, b), std::max(a, b), BOUNDS_LIBM_ULPS);
+    if (containsPeriodic(x, maxPhase, 2 * PI)) {
+        result.hi = 1;
+    }
+    if (containsPeriodic(x, maxPhase + PI, 2 * PI)) {
+        result.lo = -1;
+    }
+    return Bounds(std::max(result.lo, -1.0), std::min(result.hi, 1.0));
+}
+
+// tan and cot are monotonic between poles at polePhase + k pi
+Bounds tangent(const Bounds& x, double polePhase, bool increasing) {
+    if (x.isEmpty()) {
+        return x;
+    }
+    if (!std::isfinite(x.lo) || !std::isfinite(x.hi) || x.width() >= PI || containsPeriodic(x, polePhase, PI)) {
+        return Bounds::entire();
+    }
+    double a = std::tan(x.lo);
+    double b = std::tan(x.hi);
+    if (!increasing) {
+        a = 1 / a;
+        b = 1 / b;
+        return outward(b, a, BOUNDS_LIBM_ULPS + 1);
+    }
+    return outward(a, b, BOUNDS_LIBM_ULPS);
+}
+
+bool isInteger(double x) {
+    return std::isfinite(x) && x == std::floor(x);
+}
+
+Bounds integerPower(const Bounds& base, double power) {
+    if (power == 0) {
+        return Bounds(1);
+    }
+    if (power < 0) {
+        return Bounds(1) / integerPower(base, -power);
+    }
+    double a = std::pow(base.lo, power);
+    double b = std::pow(base.hi, power);
+    bool even = std::fmod(power, 2) == 0;
+    if (!even) {
+        return outward(a, b, BOUNDS_LIBM_ULPS);
+    }
+    if (base.lo >= 0) {
+        return outward(a, b, BOUNDS_LIBM_ULPS);
+    }
+    if (base.hi <= 0) {
+        return outward(b, a, BOUNDS_LIBM_ULPS);
+    }
+    return Bounds(0, up(std::max(a, b), BOUNDS_LIBM_ULPS));
+}
+}  // namespace
+
+Bounds::Bounds(double value) : lo(value), hi(value) {
+}
+
+Bounds::Bounds(double lo, double hi) : lo(lo), hi(hi) {
+}
+
+Bounds Bounds::empty() {
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    return Bounds(nan, nan);
+}
+
+Bounds Bounds::entire() {
+    return Bounds(-INF, INF);
+}
+
+bool Bounds::isEmpty() const {
+    return std::isnan(lo) || std::isnan(hi);
+}
+
+bool Bounds::contains(double value) const {
+    return lo <= value && value <= hi;
+}
+
+double Bounds::width() const {
+    return hi - lo;
+}
+
+double Bounds::middle() const {
+    return lo + (hi - lo) / 2;
+}
+
+Bounds operator-(const Bounds& a) {
+    return Bounds(-a.hi, -a.lo);
+}
+
+Bounds operator+(const Bounds& a, const Bounds& b) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return Bounds::empty();
+    }
+    return outward(a.lo + b.lo, a.hi + b.hi);
+}
+
+Bounds operator-(const Bounds& a, const Bounds& b) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return Bounds::empty();
+    }
+    return outward(a.lo - b.hi, a.hi - b.lo);
+}
+
+Bounds operator*(const Bounds& a, const Bounds& b) {
+    if (a.isEmpty() || b.isEmpty()) {
+        return Bounds::empty();
+    }
+    double p1 = product(a.lo, b.lo);
+    double p2 = product(a.lo, b.hi);
+    double p3 = product(a.hi, b.lo);
+    double p4 = product(a.hi, b.hi);
+    return outward(std::min(std::min(p1, p2), std::min(p3, p4)), std::max(std::max(p1, p2), std::max(p3, p4)));
+}
+
+Bounds operator/(const Bounds& a, const Bounds& b) {
+    if (a.isEmpty() || b.isEmpty() || (b.lo == 0 && b.hi == 0)) {
+        return Bounds::empty();
+    }
+    if (b.lo > 0 || b.hi < 0) {
+        double q1 = a.lo / b.lo;
+        double q2 = a.lo / b.hi;
+        double q3 = a.hi / b.lo;
+        double q4 = a.hi / b.hi;
+        return outward(std::min(std::min(q1, q2), std::min(q3, q4)), std::max(std::max(q1, q2), std::max(q3, q4)));
+    }
+    // divisor touches zero from one side, quotient goes to infinity on one side
+    if (b.lo == 0) {
+        if (a.lo >= 0) {
+            return Bounds(down(a.lo / b.hi), INF);
+        }
+        if (a.hi <= 0) {
+            return Bounds(-INF, up(a.hi / b.hi));
+        }
+    } else if (b.hi == 0) {
+        if (a.lo >= 0) {
+            return Bounds(-INF, up(a.lo / b.lo));
+        }
+        if (a.hi <= 0) {
+            return Bounds(down(a.hi / b.lo), INF);
+        }
+    }
+    return Bounds::entire();
+}
+
+bool operator==(const Bounds& a, const Bounds& b) {
+    return a.lo == b.lo && a.hi == b.hi;
+}
+
+bool operator!=(const Bounds& a, const Bounds& b) {
+    return !(a == b);
+}
+
+Bounds lowerPower(const Bounds& value, const Bounds& base, const Bounds& exponent) {
+    // b^e / b would blow up near zero, value is only there to match the generic signature
+    (void)value;
+    // integer exponents stay exact so negative bases remain in the domain
+    if (exponent.lo == exponent.hi && isInteger(exponent.lo)) {
+        return bounds::pow(base, Bounds(exponent.lo - 1));
+    }
+    return bounds::pow(base, exponent - Bounds(1));
+}
+
+namespace bounds {
+
+Bounds sin(const Bounds& x) {
+    return periodic(x, std::sin, PI_2);
+}
+
+Bounds cos(const Bounds& x) {
+    return periodic(x, std::cos, 0);
+}
+
+Bounds tan(const Bounds& x) {
+    return tangent(x, PI_2, true);
+}
+
+Bounds cot(const Bounds& x) {
+    return tangent(x, 0, false);
+}
+
+Bounds ln(const Bounds& x) {
+    if (x.isEmpty() || x.hi <= 0) {
+        return Bounds::empty();
+    }
+    double lo = x.lo > 0 ? std::log(x.lo) : -INF;
+    return outward(lo, std::log(x.hi), BOUNDS_LIBM_ULPS);
+}
+
+Bounds pow(const Bounds& base, const Bounds& exponent) {
+    if (base.isEmpty() || exponent.isEmpty()) {
+        return Bounds::empty();
+    }
+    if (exponent.lo == exponent.hi && isInteger(exponent.lo)) {
+        return integerPower(base, exponent.lo);
+    }
+    // negative bases are only in the domain for integer exponents
+    if (base.lo < 0 && std::ceil(exponent.lo) <= std::floor(exponent.hi)) {
+        return Bounds::entire();
+    }
+    if (base.hi < 0) {
+        return Bounds::empty();
+    }
+    // x^y is monotonic in each argument for x >= 0, so extremes are at the corners
+    double lo = std::max(base.lo, 0.0);
+    double p1 = std::pow(lo, exponent.lo);
+    double p2 = std::pow(lo, exponent.hi);
+    double p3 = std::pow(base.hi, exponent.lo);
+    double p4 = std::pow(base.hi, exponent.hi);
+    Bounds result = outward(std::min(std::min(p1, p2), std::min(p3, p4)), std::max(std::max(p1, p2), std::max(p3, p4)),
+                            BOUNDS_LIBM_ULPS);
+    return Bounds(std::max(result.lo, 0.0), result.hi);
+}
+
+Bounds sqrt(const Bounds& x) {
+    if (x.isEmpty() || x.hi < 0) {
+        return Bounds::empty();
+    }
+    return Bounds(x.lo > 0 ? down(std::sqrt(x.lo)) : 0, up(std::sqrt(x.hi)));
+}
+
+Bounds abs(const Bounds& x) {
+    if (x.isEmpty() || x.lo >= 0) {
+        return x;
+    }
+    if (x.hi <= 0) {
+        return -x;
+    }
+    return Bounds(0, std::max(-x.lo, x.hi));
+}
+
+Bounds sign(const Bounds& x) {
+    if (x.isEmpty()) {
+        return x;
+    }
+    return Bounds(x.lo > 0 ? 1 : (x.lo < 0 ? -1 : 0), x.hi > 0 ? 1 : (x.hi < 0 ? -1 : 0));
+}
+
+}  // namespace bounds
+}  // namespace math
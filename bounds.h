@@ -0,0 +1,67 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "kernel.h"
+
+namespace math {
+
+// Closed interval [lo, hi] of reals, used to enclose the range of an equation over a whole
+// interval of x. Every operation rounds outward, so the true range is always contained.
+// Part of the argument outside of a function domain is ignored (sqrt, ln, pow of negative base);
+// an empty result (no point of the argument in the domain) is stored as NaN bounds.
+struct Bounds {
+    double lo;
+    double hi;
+
+    Bounds(double value = 0);
+    Bounds(double lo, double hi);
+
+    static Bounds empty();
+    static Bounds entire();
+
+    bool isEmpty() const;
+    bool contains(double value) const;
+    double width() const;
+    double middle() const;
+};
+
+Bounds operator-(const Bounds& a);
+Bounds operator+(const Bounds& a, const Bounds& b);
+Bounds operator-(const Bounds& a, const Bounds& b);
+Bounds operator*(const Bounds& a, const Bounds& b);
+Bounds operator/(const Bounds& a, const Bounds& b);
+bool operator==(const Bounds& a, const Bounds& b);
+bool operator!=(const Bounds& a, const Bounds& b);
+
+// Power rule of Dual<Bounds>, b^e / b is unbounded whenever b contains zero
+Bounds lowerPower(const Bounds& value, const Bounds& base, const Bounds& exponent);
+
+namespace bounds {
+Bounds sin(const Bounds& x);
+Bounds cos(const Bounds& x);
+Bounds tan(const Bounds& x);
+Bounds cot(const Bounds& x);
+Bounds ln(const Bounds& x);
+Bounds pow(const Bounds& base, const Bounds& exponent);
+Bounds sqrt(const Bounds& x);
+Bounds abs(const Bounds& x);
+Bounds sign(const Bounds& x);
+}  // namespace bounds
+
+template <>
+struct Kernel<Bounds> {
+    static Bounds sin(const Bounds& x) { return bounds::sin(x); }
+    static Bounds cos(const Bounds& x) { return bounds::cos(x); }
+    static Bounds tan(const Bounds& x) { return bounds::tan(x); }
+    static Bounds cot(const Bounds& x) { return bounds::cot(x); }
+    static Bounds ln(const Bounds& x) { return bounds::ln(x); }
+    static Bounds log(const Bounds& base, const Bounds& value) { return bounds::ln(value) / bounds::ln(base); }
+    static Bounds pow(const Bounds& base, const Bounds& exponent) { return bounds::pow(base, exponent); }
+    static Bounds sqrt(const Bounds& x) { return bounds::sqrt(x); }
+    static Bounds abs(const Bounds& x) { return bounds::abs(x); }
+    static Bounds sign(const Bounds& x) { return bounds::sign(x); }
+};
+
+}  // namespace math
+
+#endif  // BOUNDS_H
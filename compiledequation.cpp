@@ -0,0 +1,528 @@
+#include "compiledequation.h"
+#include "doubledouble.h"
+#include "dual.h"
+#include "kernel.h"
+#include "taylor.h"
+#include "vectormath.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace math {
+
+// Programs with a shallower stack are evaluated without touching the heap
+#define COMPILED_STACK_SIZE 64
+
+namespace {
+template <typename T>
+T run(const std::vector<Instruction>& program, T x, T* stack, T* slots) {
+    T* top = stack - 1;
+    const Instruction* end = program.data() + program.size();
+    for (const Instruction* ip = program.data(); ip != end; ++ip) {
+        switch (ip->opcode) {
+            case Opcode::Constant:
+                *++top = T(ip->value);
+                break;
+            case Opcode::Variable:
+                *++top = x;
+                break;
+            case Opcode::Drop:
+                top--;
+                break;
+            case Opcode::Store:
+                slots[(size_t)ip->value] = *top;
+                break;
+            case Opcode::Load:
+                *++top = slots[(size_t)ip->value];
+                break;
+            case Opcode::Add:
+                top--;
+                top[0] = top[0] + top[1];
+                break;
+            case Opcode::Subtract:
+                top--;
+                top[0] = top[0] - top[1];
+                break;
+            case Opcode::Negate:
+                top[0] = -top[0];
+                break;
+            case Opcode::Multiply:
+                top--;
+                top[0] = top[0] * top[1];
+                break;
+            case Opcode::Divide:
+                top--;
+                top[0] = top[0] / top[1];
+                break;
+            case Opcode::Power:
+                top--;
+                top[0] = Kernel<T>::pow(top[0], top[1]);
+                break;
+            case Opcode::Abs:
+                top[0] = Kernel<T>::abs(top[0]);
+                break;
+            case Opcode::Sign:
+                top[0] = Kernel<T>::sign(top[0]);
+                break;
+            case Opcode::Sqrt:
+                top[0] = Kernel<T>::sqrt(top[0]);
+                break;
+            case Opcode::Sin:
+                top[0] = Kernel<T>::sin(top[0]);
+                break;
+            case Opcode::Cos:
+                top[0] = Kernel<T>::cos(top[0]);
+                break;
+            case Opcode::Tan:
+                top[0] = Kernel<T>::tan(top[0]);
+                break;
+            case Opcode::Cot:
+                top[0] = Kernel<T>::cot(top[0]);
+                break;
+            case Opcode::Ln:
+                top[0] = Kernel<T>::ln(top[0]);
+                break;
+            case Opcode::Log:
+                top--;
+                top[0] = Kernel<T>::log(top[0], top[1]);
+                break;
+        }
+    }
+    return *top;
+}
+
+// Slots are kept after the stack
+template <typename T>
+T runScalar(const std::vector<Instruction>& program, size_t stackSize, size_t slotCount, T x) {
+    if (stackSize + slotCount <= COMPILED_STACK_SIZE) {
+        T stack[COMPILED_STACK_SIZE];
+        return run(program, x, stack, stack + stackSize);
+    }
+    std::vector<T> stack(stackSize + slotCount);
+    return run(program, x, stack.data(), stack.data() + stackSize);
+}
+
+// Same as run, but every stack slot holds a whole block of values and each instruction
+// is a tight loop over the block
+void runBatch(const std::vector<Instruction>& program, const double* xs, size_t count, double* stack, double* slots) {
+    const size_t block = COMPILED_BATCH_SIZE;
+    double* top = stack - block;
+    const Instruction* end = program.data() + program.size();
+    for (const Instruction* ip = program.data(); ip != end; ++ip) {
+        double* a = top - block;
+        double* b = top;
+        switch (ip->opcode) {
+            case Opcode::Constant: {
+                top += block;
+                double value = ip->value;
+                for (size_t i = 0; i < count; i++) {
+                    top[i] = value;
+                }
+                break;
+            }
+            case Opcode::Variable:
+                top += block;
+                for (size_t i = 0; i < count; i++) {
+                    top[i] = xs[i];
+                }
+                break;
+            case Opcode::Drop:
+                top -= block;
+                break;
+            case Opcode::Store: {
+                double* slot = slots + (size_t)ip->value * block;
+                for (size_t i = 0; i < count; i++) {
+                    slot[i] = b[i];
+                }
+                break;
+            }
+            case Opcode::Load: {
+                top += block;
+                double* slot = slots + (size_t)ip->value * block;
+                for (size_t i = 0; i < count; i++) {
+                    top[i] = slot[i];
+                }
+                break;
+            }
+            case Opcode::Add:
+                top -= block;
+                for (size_t i = 0; i < count; i++) {
+                    a[i] = a[i] + b[i];
+                }
+                break;
+            case Opcode::Subtract:
+                top -= block;
+                for (size_t i = 0; i < count; i++) {
+                    a[i] = a[i] - b[i];
+                }
+                break;
+            case Opcode::Negate:
+                for (size_t i = 0; i < count; i++) {
+                    b[i] = -b[i];
+                }
+                break;
+            case Opcode::Multiply:
+                top -= block;
+                for (size_t i = 0; i < count; i++) {
+                    a[i] = a[i] * b[i];
+                }
+                break;
+            case Opcode::Divide:
+                top -= block;
+                for (size_t i = 0; i < count; i++) {
+                    a[i] = a[i] / b[i];
+                }
+                break;
+            case Opcode::Power:
+                top -= block;
+                vectormath::pow(a, b, a, count);
+                break;
+            case Opcode::Abs:
+                vectormath::abs(b, b, count);
+                break;
+            case Opcode::Sign:
+                vectormath::sign(b, b, count);
+                break;
+            case Opcode::Sqrt:
+                vectormath::sqrt(b, b, count);
+                break;
+            case Opcode::Sin:
+                vectormath::sin(b, b, count);
+                break;
+            case Opcode::Cos:
+                vectormath::cos(b, b, count);
+                break;
+            case Opcode::Tan:
+                vectormath::tan(b, b, count);
+                break;
+            case Opcode::Cot:
+                vectormath::cot(b, b, count);
+                break;
+            case Opcode::Ln:
+                vectormath::ln(b, b, count);
+                break;
+            case Opcode::Log:
+                top -= block;
+                vectormath::log(a, b, a, count);
+                break;
+        }
+    }
+}
+// Same as run, but every stack slot holds n Taylor coefficients of a value.
+// scratch holds 3n values
+void runTaylor(const std::vector<Instruction>& program, double x, size_t n, double* stack, double* slots, double* scratch) {
+    double* top = stack - n;
+    const Instruction* end = program.data() + program.size();
+    for (const Instruction* ip = program.data(); ip != end; ++ip) {
+        double* a = top - n;
+        double* b = top;
+        switch (ip->opcode) {
+            case Opcode::Constant:
+            case Opcode::Variable:
+                top += n;
+                std::fill(top, top + n, 0.0);
+                if (ip->opcode == Opcode::Constant) {
+                    top[0] = ip->value;
+                } else {
+                    top[0] = x;
+                    if (n > 1) {
+                        top[1] = 1;
+                    }
+                }
+                break;
+            case Opcode::Drop:
+                top -= n;
+                break;
+            case Opcode::Store:
+                std::copy(b, b + n, slots + (size_t)ip->value * n);
+                break;
+            case Opcode::Load: {
+                top += n;
+                double* slot = slots + (size_t)ip->value * n;
+                std::copy(slot, slot + n, top);
+                break;
+            }
+            case Opcode::Add:
+                top -= n;
+                for (size_t i = 0; i < n; i++) {
+                    a[i] += b[i];
+                }
+                break;
+            case Opcode::Subtract:
+                top -= n;
+                for (size_t i = 0; i < n; i++) {
+                    a[i] -= b[i];
+                }
+                break;
+            case Opcode::Negate:
+                for (size_t i = 0; i < n; i++) {
+                    b[i] = -b[i];
+                }
+                break;
+            case Opcode::Multiply:
+                top -= n;
+                taylor::multiply(a, b, scratch, n);
+                std::copy(scratch, scratch + n, a);
+                break;
+            case Opcode::Divide:
+                top -= n;
+                taylor::divide(a, b, scratch, n);
+                std::copy(scratch, scratch + n, a);
+                break;
+            case Opcode::Power:
+                top -= n;
+                taylor::pow(a, b, scratch, scratch + n, n);
+                std::copy(scratch, scratch + n, a);
+                break;
+            case Opcode::Abs: {
+                // derivatives of |u| are sign(u) times those of u, away from zero
+                double sign = Kernel<double>::sign(b[0]);
+                for (size_t i = 0; i < n; i++) {
+                    b[i] *= sign;
+                }
+                break;
+            }
+            case Opcode::Sign:
+                b[0] = Kernel<double>::sign(b[0]);
+                std::fill(b + 1, b + n, 0.0);
+                break;
+            case Opcode::Sqrt:
+                taylor::sqrt(b, scratch, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Sin:
+                taylor::sinCos(b, scratch, scratch + n, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Cos:
+                taylor::sinCos(b, scratch + n, scratch, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Tan:
+                taylor::tan(b, scratch, scratch + n, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Cot:
+                taylor::cot(b, scratch, scratch + n, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Ln:
+                taylor::ln(b, scratch, n);
+                std::copy(scratch, scratch + n, b);
+                break;
+            case Opcode::Log:
+                top -= n;
+                taylor::ln(a, scratch, n);
+                taylor::ln(b, scratch + n, n);
+                taylor::divide(scratch + n, scratch, a, n);
+                break;
+        }
+    }
+}
+}  // namespace
+
+CompiledEquation::CompiledEquation(Entry* source, Precision precision) {
+    this->source = source;
+    this->stackDepth = 0;
+    this->stackSize = 0;
+    this->slotCount = 0;
+    this->precision = precision;
+    countReferences(source);
+    compile(source);
+}
+
+void CompiledEquation::countReferences(Entry* entry) {
+    Operator* op = dynamic_cast<Operator*>(entry);
+    if (op == nullptr) {
+        return;
+    }
+    if (references[op]++ > 0) {
+        return;
+    }
+    const std::vector<Entry*>& inputs = op->getInputs();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        countReferences(inputs[i]);
+    }
+}
+
+void CompiledEquation::compile(Entry* entry) {
+    auto shared = references.find(entry);
+    if (shared == references.end() || shared->second < 2) {
+        entry->compile(*this);
+        return;
+    }
+    auto slot = slots.find(entry);
+    if (slot != slots.end()) {
+        emit(Opcode::Load, slot->second);
+        return;
+    }
+    entry->compile(*this);
+    slots[entry] = slotCount;
+    emit(Opcode::Store, slotCount);
+    slotCount++;
+}
+
+void CompiledEquation::compile(CompiledEquation& program) {
+    program.compile(source);
+}
+
+void CompiledEquation::emit(Opcode opcode, double value) {
+    Instruction instruction;
+    instruction.opcode = opcode;
+    instruction.value = value;
+    program.push_back(instruction);
+
+    switch (opcode) {
+        case Opcode::Constant:
+        case Opcode::Variable:
+        case Opcode::Load:
+            stackDepth++;
+            if (stackDepth > stackSize) {
+                stackSize = stackDepth;
+            }
+            break;
+        case Opcode::Drop:
+        case Opcode::Add:
+        case Opcode::Subtract:
+        case Opcode::Multiply:
+        case Opcode::Divide:
+        case Opcode::Power:
+        case Opcode::Log:
+            stackDepth--;
+            break;
+        default:
+            break;
+    }
+}
+
+void CompiledEquation::emitFunction(Opcode opcode, size_t arity, size_t size) {
+    for (size_t i = arity; i < size; i++) {
+        emit(Opcode::Drop);
+    }
+    emit(opcode);
+}
+
+void CompiledEquation::emitFold(Opcode opcode, size_t size) {
+    for (size_t i = 1; i < size; i++) {
+        emit(opcode);
+    }
+}
+
+size_t CompiledEquation::instructionCount() {
+    return program.size();
+}
+
+Entry* CompiledEquation::getSource() {
+    return source;
+}
+
+double CompiledEquation::calculate(double x) {
+    switch (precision) {
+        case Precision::Extended:
+            return runScalar<DoubleDouble>(program, stackSize, slotCount, x).toDouble();
+        default:
+            return runScalar<double>(program, stackSize, slotCount, x);
+    }
+}
+
+double CompiledEquation::calculateWithDerivative(double x, double& derivative) {
+    switch (precision) {
+        case Precision::Extended: {
+            Dual<DoubleDouble> result = runScalar(program, stackSize, slotCount, Dual<DoubleDouble>(x, 1));
+            derivative = result.derivative.toDouble();
+            return result.value.toDouble();
+        }
+        default: {
+            Dual<double> result = runScalar(program, stackSize, slotCount, Dual<double>(x, 1));
+            derivative = result.derivative;
+            return result.value;
+        }
+    }
+}
+
+void CompiledEquation::evaluateBatchWithDerivative(const double* xs, double* ys, double* derivatives, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ys[i] = calculateWithDerivative(xs[i], derivatives[i]);
+    }
+}
+
+void CompiledEquation::calculateDerivatives(double x, size_t order, double* derivatives) {
+    size_t n = order + 1;
+    size_t size = (stackSize + slotCount + 3) * n;
+    double local[COMPILED_STACK_SIZE * 4];
+    std::vector<double> heap;
+    double* memory = local;
+    if (size > COMPILED_STACK_SIZE * 4) {
+        heap.resize(size);
+        memory = heap.data();
+    }
+    double* slotSeries = memory + stackSize * n;
+    runTaylor(program, x, n, memory, slotSeries, slotSeries + slotCount * n);
+
+    double factorial = 1;
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0) {
+            factorial *= i;
+        }
+        derivatives[i] = memory[i] * factorial;
+    }
+}
+
+std::complex<double> CompiledEquation::calculate(std::complex<double> z) {
+    return runScalar(program, stackSize, slotCount, z);
+}
+
+Bounds CompiledEquation::calculateBounds(const Bounds& x) {
+    return runScalar<Bounds>(program, stackSize, slotCount, x);
+}
+
+Bounds CompiledEquation::calculateBoundsWithDerivative(const Bounds& x, Bounds& derivative) {
+    Dual<Bounds> result = runScalar(program, stackSize, slotCount, Dual<Bounds>(x, 1));
+    derivative = result.derivative;
+    for (const Instruction& instruction : program) {
+        if (instruction.opcode == Opcode::Sign) {
+            derivative = Bounds::entire();
+        }
+    }
+    return result.value;
+}
+
+void CompiledEquation::evaluateBatch(const double* xs, double* ys, size_t n) {
+    if (precision == Precision::Extended) {
+        for (size_t i = 0; i < n; i++) {
+            ys[i] = runScalar<DoubleDouble>(program, stackSize, slotCount, xs[i]).toDouble();
+        }
+        return;
+    }
+    std::vector<double> stack((stackSize + slotCount) * COMPILED_BATCH_SIZE);
+    double* slotBlocks = stack.data() + stackSize * COMPILED_BATCH_SIZE;
+    for (size_t start = 0; start < n; start += COMPILED_BATCH_SIZE) {
+        size_t count = std::min(n - start, (size_t)COMPILED_BATCH_SIZE);
+        runBatch(program, xs + start, count, stack.data(), slotBlocks);
+        for (size_t i = 0; i < count; i++) {
+            ys[start + i] = stack[i];
+        }
+    }
+}
+
+Entry* CompiledEquation::evaluate(double x) {
+    return new ConstantEntry(calculate(x));
+}
+
+Entry* CompiledEquation::copy() {
+    return source->copy();
+}
+
+bool CompiledEquation::isVariable() {
+    return source->isVariable();
+}
+
+Entry* CompiledEquation::getDerivative() {
+    return source->getDerivative();
+}
+
+std::string CompiledEquation::to_string(Entry const& entry) {
+    return source->to_string(entry);
+}
+
+}  // namespace math
@@ -0,0 +1,122 @@
+#ifndef COMPILEDEQUATION_H
+#define COMPILEDEQUATION_H
+#include <complex>
+#include <unordered_map>
+#include <vector>
+
+#include "bounds.h"
+#include "equation.h"
+
+namespace math {
+
+// Number of points evaluated together by each instruction in batch mode
+#define COMPILED_BATCH_SIZE 256
+
+enum class Opcode : unsigned char {
+    Constant,
+    Variable,
+    Drop,
+    // keep a copy of the top value in a slot, for nodes used more than once
+    Store,
+    // push value of a slot
+    Load,
+    Add,
+    Subtract,
+    Negate,
+    Multiply,
+    Divide,
+    Power,
+    Abs,
+    Sign,
+    Sqrt,
+    Sin,
+    Cos,
+    Tan,
+    Cot,
+    Ln,
+    Log
+};
+
+// Number type the interpreter works in. There is no float policy: plotting runs the batch path, where float
+// blocks measured slower than the vectorized double kernels, as float transcendentals are scalar libm calls
+enum class Precision : unsigned char {
+    Double,
+    // double-double, about 31 significant digits, tens of times slower than Double
+    Extended
+};
+
+struct Instruction {
+    Opcode opcode;
+    // constant value, or slot index for Store and Load
+    double value;
+};
+
+// Equation tree lowered into a flat postfix program, evaluated by a stack interpreter.
+// Source tree is not owned and must outlive the compiled equation.
+// Operators shared by several parents (see NodeArena::intern) are computed once per point.
+class CompiledEquation : public Entry {
+protected:
+    Entry* source;
+    std::vector<Instruction> program;
+    size_t stackDepth;
+    size_t stackSize;
+    size_t slotCount;
+    Precision precision;
+    // number of parents of every operator in the source
+    std::unordered_map<Entry*, size_t> references;
+    // slot holding the value of already compiled shared operators
+    std::unordered_map<Entry*, size_t> slots;
+
+    void countReferences(Entry* entry);
+
+public:
+    CompiledEquation(Entry* source, Precision precision = Precision::Double);
+
+    // Lower an entry of the source tree, used by Entry::compile for its inputs
+    void compile(Entry* entry);
+    void emit(Opcode opcode, double value = 0);
+    // Emit a function of `arity` arguments, dropping extra inputs it ignores
+    void emitFunction(Opcode opcode, size_t arity, size_t size);
+    // Emit a function taking `size` arguments folded pairwise (add, mul)
+    void emitFold(Opcode opcode, size_t size);
+
+    size_t instructionCount();
+    Entry* getSource();
+
+    void compile(CompiledEquation& program) override;
+
+    double calculate(double x) override;
+
+    // f(x) and f'(x) in one pass with forward mode automatic differentiation
+    double calculateWithDerivative(double x, double& derivative);
+    void evaluateBatchWithDerivative(const double* xs, double* ys, double* derivatives, size_t n);
+    // f(x), f'(x), ..., f^(order)(x) in one pass with Taylor mode automatic differentiation,
+    // costs O(order^2) per instruction. Always runs in double precision.
+    void calculateDerivatives(double x, size_t order, double* derivatives);
+
+    // f at a complex point, every operator continued to its principal branch. Always runs in double precision.
+    std::complex<double> calculate(std::complex<double> z);
+
+    // Enclosure of f over the whole of x with outward rounded interval arithmetic.
+    // Always runs in double precision.
+    Bounds calculateBounds(const Bounds& x);
+    // Also encloses f' over x. Jumps of sign() have no derivative bound, so derivative is the whole
+    // real line for equations using it.
+    Bounds calculateBoundsWithDerivative(const Bounds& x, Bounds& derivative);
+
+    void evaluateBatch(const double* xs, double* ys, size_t n) override;
+
+    Entry* evaluate(double x) override;
+
+    Entry* copy() override;
+
+    bool isVariable() override;
+
+    Entry* getDerivative() override;
+
+    std::string to_string(Entry const&) override;
+};
+
+}  // namespace math
+
+#endif  // COMPILEDEQUATION_H
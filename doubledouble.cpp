@@ -0,0 +1,235 @@
+#include "doubledouble.h"
+
+#include <cmath>
+
+namespace math {
+
+namespace {
+const DoubleDouble LN2(6.93147180559945286227e-01, 2.31904681384629955842e-17);
+const DoubleDouble PI_2(1.57079632679489655800e+00, 6.12323399573676603587e-17);
+// pi / 2 - PI_2, keeps argument reduction accurate near multiples of pi / 2
+const double PI_2_TAIL = -1.4973849048591698e-33;
+
+// Error free transformations, see Dekker "A floating-point technique for extending the available precision"
+DoubleDouble twoSum(double a, double b) {
+    double s = a + b;
+    double v = s - a;
+    return DoubleDouble(s, (a - (s - v)) + (b - v));
+}
+
+// Requires |a| >= |b|
+DoubleDouble quickTwoSum(double a, double b) {
+    double s = a + b;
+    return DoubleDouble(s, b - (s - a));
+}
+
+DoubleDouble twoProduct(double a, double b) {
+    double p = a * b;
+#ifdef FP_FAST_FMA
+    return DoubleDouble(p, std::fma(a, b, -p));
+#else
+    const double splitter = 134217729.0;  // 2^27 + 1
+    double t = splitter * a;
+    double ah = t - (t - a);
+    double al = a - ah;
+    t = splitter * b;
+    double bh = t - (t - b);
+    double bl = b - bh;
+    return DoubleDouble(p, ((ah * bh - p) + ah * bl + al * bh) + al * bl);
+#endif
+}
+
+DoubleDouble scale(const DoubleDouble& x, int exponent) {
+    return DoubleDouble(std::ldexp(x.hi, exponent), std::ldexp(x.lo, exponent));
+}
+
+// 1 / n! for the Taylor series below
+#define INVERSE_FACTORIALS 30
+
+struct InverseFactorials {
+    DoubleDouble values[INVERSE_FACTORIALS];
+
+    InverseFactorials() {
+        values[0] = 1;
+        for (int i = 1; i < INVERSE_FACTORIALS; i++) {
+            values[i] = values[i - 1] / i;
+        }
+    }
+};
+
+const DoubleDouble& inverseFactorial(int n) {
+    static const InverseFactorials table;
+    return table.values[n];
+}
+}  // namespace
+
+DoubleDouble::DoubleDouble(double value) {
+    hi = value;
+    lo = 0;
+}
+
+DoubleDouble::DoubleDouble(double hi, double lo) {
+    this->hi = hi;
+    this->lo = lo;
+}
+
+double DoubleDouble::toDouble() const {
+    return hi;
+}
+
+DoubleDouble operator-(const DoubleDouble& a) {
+    return DoubleDouble(-a.hi, -a.lo);
+}
+
+DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b) {
+    DoubleDouble s = twoSum(a.hi, b.hi);
+    if (!std::isfinite(s.hi)) {
+        return s.hi;
+    }
+    DoubleDouble t = twoSum(a.lo, b.lo);
+    s = quickTwoSum(s.hi, s.lo + t.hi);
+    return quickTwoSum(s.hi, s.lo + t.lo);
+}
+
+DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b) {
+    return a + -b;
+}
+
+DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b) {
+    DoubleDouble p = twoProduct(a.hi, b.hi);
+    if (!std::isfinite(p.hi)) {
+        return p.hi;
+    }
+    return quickTwoSum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+}
+
+DoubleDouble operator/(const DoubleDouble& a, const DoubleDouble& b) {
+    double q1 = a.hi / b.hi;
+    if (!std::isfinite(q1)) {
+        return q1;
+    }
+    DoubleDouble r = a - b * q1;
+    double q2 = r.hi / b.hi;
+    r = r - b * q2;
+    double q3 = r.hi / b.hi;
+    return quickTwoSum(q1, q2) + q3;
+}
+
+bool operator<(const DoubleDouble& a, const DoubleDouble& b) {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+bool operator==(const DoubleDouble& a, const DoubleDouble& b) {
+    return a.hi == b.hi && a.lo == b.lo;
+}
+
+bool operator!=(const DoubleDouble& a, const DoubleDouble& b) {
+    return !(a == b);
+}
+
+namespace dd {
+
+DoubleDouble sqrt(const DoubleDouble& x) {
+    if (!(x.hi > 0) || !std::isfinite(x.hi)) {
+        return std::sqrt(x.hi);
+    }
+    // One Newton step from the double result doubles the number of correct bits
+    double s = std::sqrt(x.hi);
+    return DoubleDouble(s) + (x - twoProduct(s, s)).hi / (2 * s);
+}
+
+DoubleDouble exp(const DoubleDouble& x) {
+    if (!std::isfinite(x.hi) || x.hi > 709.78 || x.hi < -745.2) {
+        return std::exp(x.hi);
+    }
+    // exp(x) = 2^k * exp(r)^1024, |r| <= ln2 / 2048
+    double k = std::nearbyint(x.hi / LN2.hi);
+    DoubleDouble r = scale(x - twoProduct(LN2.hi, k) - LN2.lo * k, -10);
+
+    // expm1(r) by Taylor series, squared back up with expm1(2r) = expm1(r) * (expm1(r) + 2)
+    DoubleDouble sum = inverseFactorial(9);
+    for (int i = 8; i >= 1; i--) {
+        sum = sum * r + inverseFactorial(i);
+    }
+    sum = sum * r;
+    for (int i = 0; i < 10; i++) {
+        sum = sum * (sum + 2);
+    }
+    return scale(sum + 1, (int)k);
+}
+
+DoubleDouble ln(const DoubleDouble& x) {
+    if (!(x.hi > 0) || !std::isfinite(x.hi)) {
+        return std::log(x.hi);
+    }
+    // Newton step y + x * exp(-y) - 1 from the double result
+    DoubleDouble y = std::log(x.hi);
+    return y + x * exp(-y) - 1;
+}
+
+DoubleDouble pow(const DoubleDouble& base, const DoubleDouble& exponent) {
+    double n = exponent.hi;
+    if (exponent.lo == 0 && n == std::floor(n) && std::abs(n) < 2147483648.0) {
+        long long power = (long long)std::abs(n);
+        DoubleDouble result = 1;
+        DoubleDouble factor = base;
+        while (power > 0) {
+            if (power & 1) {
+                result = result * factor;
+            }
+            factor = factor * factor;
+            power >>= 1;
+        }
+        return n < 0 ? 1 / result : result;
+    }
+    if (base.hi > 0) {
+        return exp(exponent * ln(base));
+    }
+    return std::pow(base.hi, exponent.hi);
+}
+
+void sincos(const DoubleDouble& x, DoubleDouble& sin, DoubleDouble& cos) {
+    // Reduction below loses precision for huge arguments, where double is as good as it gets
+    if (!(std::abs(x.hi) < 1e9)) {
+        sin = std::sin(x.hi);
+        cos = std::cos(x.hi);
+        return;
+    }
+    double k = std::nearbyint(x.hi / PI_2.hi);
+    // each product is exact, so the cancelling subtractions lose nothing
+    DoubleDouble r = x - twoProduct(PI_2.hi, k) - twoProduct(PI_2.lo, k) - PI_2_TAIL * k;
+    DoubleDouble r2 = r * r;
+
+    // Taylor series on |r| <= pi / 4, terms past r^29 are below the precision
+    DoubleDouble s = inverseFactorial(29);
+    DoubleDouble c = inverseFactorial(28);
+    for (int i = 27; i >= 1; i -= 2) {
+        // r^i and r^(i - 1) share the sign (-1)^((i - 1) / 2)
+        double sign = (i & 2) ? -1 : 1;
+        s = s * r2 + inverseFactorial(i) * sign;
+        c = c * r2 + inverseFactorial(i - 1) * sign;
+    }
+    s = s * r;
+
+    switch ((long long)k & 3) {
+        case 0:
+            sin = s;
+            cos = c;
+            break;
+        case 1:
+            sin = c;
+            cos = -s;
+            break;
+        case 2:
+            sin = -s;
+            cos = -c;
+            break;
+        default:
+            sin = -c;
+            cos = s;
+            break;
+    }
+}
+
+}  // namespace dd
+}  // namespace math
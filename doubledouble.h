@@ -0,0 +1,72 @@
+#ifndef DOUBLEDOUBLE_H
+#define DOUBLEDOUBLE_H
+
+#include "kernel.h"
+
+namespace math {
+
+// Unevaluated sum of two doubles giving about 106 bits of precision, used for extended precision
+// evaluation. Invariant: |lo| <= ulp(hi) / 2
+// Functions below are accurate to about 31 digits (29 for ln close to 1). Non finite values and
+// arguments outside of the supported range fall back to double.
+struct DoubleDouble {
+    double hi;
+    double lo;
+
+    DoubleDouble(double value = 0);
+    DoubleDouble(double hi, double lo);
+
+    double toDouble() const;
+};
+
+DoubleDouble operator-(const DoubleDouble& a);
+DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b);
+DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b);
+DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b);
+DoubleDouble operator/(const DoubleDouble& a, const DoubleDouble& b);
+bool operator<(const DoubleDouble& a, const DoubleDouble& b);
+bool operator==(const DoubleDouble& a, const DoubleDouble& b);
+bool operator!=(const DoubleDouble& a, const DoubleDouble& b);
+
+namespace dd {
+DoubleDouble sqrt(const DoubleDouble& x);
+DoubleDouble exp(const DoubleDouble& x);
+DoubleDouble ln(const DoubleDouble& x);
+DoubleDouble pow(const DoubleDouble& base, const DoubleDouble& exponent);
+// sine and cosine computed together
+void sincos(const DoubleDouble& x, DoubleDouble& sin, DoubleDouble& cos);
+}  // namespace dd
+
+template <>
+struct Kernel<DoubleDouble> {
+    static DoubleDouble sin(const DoubleDouble& x) {
+        DoubleDouble s, c;
+        dd::sincos(x, s, c);
+        return s;
+    }
+    static DoubleDouble cos(const DoubleDouble& x) {
+        DoubleDouble s, c;
+        dd::sincos(x, s, c);
+        return c;
+    }
+    static DoubleDouble tan(const DoubleDouble& x) {
+        DoubleDouble s, c;
+        dd::sincos(x, s, c);
+        return s / c;
+    }
+    static DoubleDouble cot(const DoubleDouble& x) {
+        DoubleDouble s, c;
+        dd::sincos(x, s, c);
+        return c / s;
+    }
+    static DoubleDouble ln(const DoubleDouble& x) { return dd::ln(x); }
+    static DoubleDouble log(const DoubleDouble& base, const DoubleDouble& value) { return dd::ln(value) / dd::ln(base); }
+    static DoubleDouble pow(const DoubleDouble& base, const DoubleDouble& exponent) { return dd::pow(base, exponent); }
+    static DoubleDouble sqrt(const DoubleDouble& x) { return dd::sqrt(x); }
+    static DoubleDouble abs(const DoubleDouble& x) { return x.hi < 0 ? -x : x; }
+    static DoubleDouble sign(const DoubleDouble& x) { return Kernel<double>::sign(x.hi); }
+};
+
+}  // namespace math
+
+#endif  // DOUBLEDOUBLE_H
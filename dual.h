@@ -0,0 +1,92 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include "kernel.h"
+
+namespace math {
+
+// Dual number value + derivative * e with e^2 = 0. Evaluating an equation on Dual(x, 1)
+// gives f(x) and f'(x) together (forward mode automatic differentiation).
+template <typename T>
+struct Dual {
+    T value;
+    T derivative;
+
+    Dual(const T& value = T(), const T& derivative = T())
+        : value(value), derivative(derivative) {
+    }
+};
+
+template <typename T>
+Dual<T> operator-(const Dual<T>& a) {
+    return Dual<T>(-a.value, -a.derivative);
+}
+
+template <typename T>
+Dual<T> operator+(const Dual<T>& a, const Dual<T>& b) {
+    return Dual<T>(a.value + b.value, a.derivative + b.derivative);
+}
+
+template <typename T>
+Dual<T> operator-(const Dual<T>& a, const Dual<T>& b) {
+    return Dual<T>(a.value - b.value, a.derivative - b.derivative);
+}
+
+template <typename T>
+Dual<T> operator*(const Dual<T>& a, const Dual<T>& b) {
+    return Dual<T>(a.value * b.value, a.derivative * b.value + a.value * b.derivative);
+}
+
+template <typename T>
+Dual<T> operator/(const Dual<T>& a, const Dual<T>& b) {
+    T value = a.value / b.value;
+    return Dual<T>(value, (a.derivative - value * b.derivative) / b.value);
+}
+
+// b^(e - 1) for the power rule, given value = b^e. Number types where division by a base near
+// zero loses too much (Bounds) overload it.
+template <typename T>
+T lowerPower(const T& value, const T& base, const T& exponent) {
+    // b^(e-1) = b^e / b saves a second pow away from zero
+    return base != T(0) ? value / base : Kernel<T>::pow(base, exponent - T(1));
+}
+
+template <typename T>
+struct Kernel<Dual<T>> {
+    typedef Kernel<T> K;
+
+    static Dual<T> sin(const Dual<T>& x) { return Dual<T>(K::sin(x.value), K::cos(x.value) * x.derivative); }
+    static Dual<T> cos(const Dual<T>& x) { return Dual<T>(K::cos(x.value), -K::sin(x.value) * x.derivative); }
+    static Dual<T> tan(const Dual<T>& x) {
+        T value = K::tan(x.value);
+        return Dual<T>(value, (T(1) + value * value) * x.derivative);
+    }
+    static Dual<T> cot(const Dual<T>& x) {
+        T value = K::cot(x.value);
+        return Dual<T>(value, -(T(1) + value * value) * x.derivative);
+    }
+    static Dual<T> ln(const Dual<T>& x) { return Dual<T>(K::ln(x.value), x.derivative / x.value); }
+    static Dual<T> log(const Dual<T>& base, const Dual<T>& value) { return ln(value) / ln(base); }
+    static Dual<T> pow(const Dual<T>& base, const Dual<T>& exponent) {
+        T value = K::pow(base.value, exponent.value);
+        T derivative = T(0);
+        // terms are skipped when they do not depend on x, so negative bases with constant exponents work
+        if (base.derivative != T(0)) {
+            derivative = exponent.value * lowerPower(value, base.value, exponent.value) * base.derivative;
+        }
+        if (exponent.derivative != T(0)) {
+            derivative = derivative + value * K::ln(base.value) * exponent.derivative;
+        }
+        return Dual<T>(value, derivative);
+    }
+    static Dual<T> sqrt(const Dual<T>& x) {
+        T value = K::sqrt(x.value);
+        return Dual<T>(value, x.derivative / (T(2) * value));
+    }
+    static Dual<T> abs(const Dual<T>& x) { return Dual<T>(K::abs(x.value), K::sign(x.value) * x.derivative); }
+    static Dual<T> sign(const Dual<T>& x) { return Dual<T>(K::sign(x.value), T(0)); }
+};
+
+}  // namespace math
+
+#endif  // DUAL_H
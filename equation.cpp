@@ -1,5 +1,8 @@
 #include "equation.h"
+#include "compiledequation.h"
 #include "equationparser.h"
+#include "kernel.h"
+#include "nodearena.h"
 
 namespace math {
 
@@ -60,7 +63,7 @@ Interval::Interval(QString interval) {
         QStringList entryValues = entryStr.split(";");
         if (entryValues.size() > 1) {
             double a = std::stod(entryValues.at(0).toStdString());
-            double b = std::stof(entryValues.at(1).toStdString());
+            double b = std::stod(entryValues.at(1).toStdString());
             if (a < b) {
                 Tuple entry = Tuple(a, b);
                 addEntry(entry);
@@ -84,6 +87,18 @@ Tuple Interval::getAt(int index) {
     return entries.at(index);
 }
 
+void* Entry::operator new(size_t size) {
+    return NodeArena::allocate(size);
+}
+
+void Entry::operator delete(void* pointer) {
+    NodeArena::release(pointer);
+}
+
+void Entry::compile(CompiledEquation& program) {
+    program.emit(Opcode::Constant, 0);
+}
+
 ConstantEntry::ConstantEntry(double value) {
     this->value = value;
 }
@@ -100,6 +115,14 @@ Entry* ConstantEntry::evaluate(double x) {
     return this;
 }
 
+double ConstantEntry::calculate(double) {
+    return value;
+}
+
+void ConstantEntry::compile(CompiledEquation& program) {
+    program.emit(Opcode::Constant, value);
+}
+
 Entry* ConstantEntry::copy() {
     return new ConstantEntry(value);
 }
@@ -112,6 +135,12 @@ Entry* ConstantEntry::getDerivative() {
     return new ConstantEntry(0);
 }
 
+Entry* ConstantEntry::intern(NodeArena& arena) {
+    std::string key = "c";
+    key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    return arena.unique(key, this);
+}
+
 std::string ConstantEntry::to_string(Entry const&) {
     return std::to_string(value);
 }
@@ -129,6 +158,14 @@ Entry* VariableEntry::evaluate(double x) {
     return this;
 }
 
+double VariableEntry::calculate(double x) {
+    return x;
+}
+
+void VariableEntry::compile(CompiledEquation& program) {
+    program.emit(Opcode::Variable);
+}
+
 Entry* VariableEntry::copy() {
     return new VariableEntry();
 }
@@ -137,6 +174,10 @@ Entry* VariableEntry::getDerivative() {
     return new ConstantEntry(1);
 }
 
+Entry* VariableEntry::intern(NodeArena& arena) {
+    return arena.unique("x", this);
+}
+
 
 bool VariableEntry::isVariable() {
     return true;
@@ -159,6 +200,14 @@ Entry* StringEntry::evaluate(double x) {
     return parsedValue;
 }
 
+double StringEntry::calculate(double x) {
+    return parsedValue->calculate(x);
+}
+
+void StringEntry::compile(CompiledEquation& program) {
+    program.compile(parsedValue);
+}
+
 Entry* StringEntry::copy() {
     return parsedValue->copy();
 }
@@ -167,6 +216,10 @@ Entry* StringEntry::getDerivative() {
     return parsedValue->getDerivative();
 }
 
+Entry* StringEntry::intern(NodeArena& arena) {
+    return arena.intern(parsedValue);
+}
+
 
 bool StringEntry::isVariable() {
     return parsedValue->isVariable();
@@ -176,6 +229,16 @@ std::string StringEntry::to_string(Entry const&) {
     return value;
 }
 
+Operator::~Operator() {
+    // arena frees the children itself
+    if (NodeArena::isArenaNode(this)) {
+        return;
+    }
+    for (auto p : input) {
+        delete p;
+    }
+}
+
 std::string Operator::getType() {
     if (getFunctionName() != "") {
         return getFunctionName();
@@ -187,25 +250,57 @@ void Operator::addInput(Entry* entry) {
     this->input.push_back(entry);
 }
 
+const std::vector<Entry*>& Operator::getInputs() {
+    return input;
+}
+
 double Operator::getValue() {
     return 0;
 }
 
 Entry* Operator::evaluate(double x) {
-    if (input.size() < acceptedArgsNumber()) {
-        qDebug() << "Function " << QString::fromStdString(this->getFunctionName()) << " got " << input.size() << " which is less than " << acceptedArgsNumber();
-        return new ConstantEntry(0);
+    return new ConstantEntry(calculate(x));
+}
+
+// Operators rarely have more inputs than this, so argument values are kept on the stack
+#define OPERATOR_STACK_ARGS 8
+
+double Operator::calculate(double x) {
+    size_t size = input.size();
+    if (size < acceptedArgsNumber()) {
+        qDebug() << "Function " << QString::fromStdString(this->getFunctionName()) << " got " << size << " which is less than " << acceptedArgsNumber();
+        return 0;
     }
 
-    std::vector<double> inputVal(input.size());
+    if (size <= OPERATOR_STACK_ARGS) {
+        double inputVal[OPERATOR_STACK_ARGS];
+        for (size_t i = 0; i < size; i++) {
+            inputVal[i] = input[i]->calculate(x);
+        }
+        return function(inputVal, size);
+    }
 
-    for (size_t i = 0; i < input.size(); i++) {
-        inputVal.at(i) = input.at(i)->evaluate(x)->getValue();
+    std::vector<double> inputVal(size);
+    for (size_t i = 0; i < size; i++) {
+        inputVal[i] = input[i]->calculate(x);
     }
+    return function(inputVal.data(), size);
+}
 
-    return new ConstantEntry(function(inputVal));
+void Operator::compile(CompiledEquation& program) {
+    if (input.size() < acceptedArgsNumber()) {
+        program.emit(Opcode::Constant, 0);
+        return;
+    }
+    for (size_t i = 0; i < input.size(); i++) {
+        program.compile(input[i]);
+    }
+    compileFunction(program, input.size());
 }
 
+void Operator::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Constant, 0, size);
+}
 
 Entry* Operator::copy() {
     Operator* copy = dynamic_cast<math::Operator*>(Factory::makeRaw(this->getType()));
@@ -215,6 +310,17 @@ Entry* Operator::copy() {
     return copy;
 }
 
+Entry* Operator::intern(NodeArena& arena) {
+    // inputs are canonical first, so two operators are identical when type and input pointers match
+    std::string key = getType();
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = arena.intern(input[i]);
+        key.push_back('\0');
+        key.append(reinterpret_cast<const char*>(&input[i]), sizeof(Entry*));
+    }
+    return arena.unique(key, this);
+}
+
 bool Operator::isVariable() {
     for (size_t i = 0; i < input.size(); i++) {
         if (input.at(i)->isVariable()) {
@@ -236,14 +342,18 @@ size_t AddFunction::acceptedArgsNumber() {
     return 2;
 }
 
-double AddFunction::function(std::vector<double> input) {
+double AddFunction::function(const double* input, size_t size) {
     double acc = 0;
-    for (size_t i = 0; i < input.size(); i++) {
-        acc += input.at(i);
+    for (size_t i = 0; i < size; i++) {
+        acc += input[i];
     }
     return acc;
 }
 
+void AddFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFold(Opcode::Add, size);
+}
+
 Entry* AddFunction::getDerivative() {
     Operator* add = new AddFunction();
     for (size_t i = 0; i < input.size(); i++) {
@@ -257,15 +367,25 @@ std::string SubtractFunction::getFunctionName() {
     return "sub";
 }
 
-double SubtractFunction::function(std::vector<double> input) {
-    if (input.size() == 2) {
-        return input.at(0) - input.at(1);
-    } else if (input.size() == 1) {
-        return -input.at(0);
+double SubtractFunction::function(const double* input, size_t size) {
+    if (size == 2) {
+        return input[0] - input[1];
+    } else if (size == 1) {
+        return -input[0];
     }
     return 0;
 }
 
+void SubtractFunction::compileFunction(CompiledEquation& program, size_t size) {
+    if (size == 2) {
+        program.emit(Opcode::Subtract);
+    } else if (size == 1) {
+        program.emit(Opcode::Negate);
+    } else {
+        program.emitFunction(Opcode::Constant, 0, size);
+    }
+}
+
 Entry* SubtractFunction::getDerivative() {
     if (input.size() == 2) {
         Operator* sub = new SubtractFunction();
@@ -273,10 +393,9 @@ Entry* SubtractFunction::getDerivative() {
         sub->addInput(input.at(1)->getDerivative());
         return sub;
     } else if (input.size() == 1) {
-        Operator* mul = new SubtractFunction();
-        mul->addInput(input.at(0)->getDerivative());
-        mul->addInput(new ConstantEntry(-1));
-        return mul;
+        Operator* neg = new SubtractFunction();
+        neg->addInput(input.at(0)->getDerivative());
+        return neg;
     }
     return new ConstantEntry(0);
 }
@@ -289,41 +408,45 @@ size_t MultiplyFunction::acceptedArgsNumber() {
     return 2;
 }
 
-double MultiplyFunction::function(std::vector<double> input) {
+double MultiplyFunction::function(const double* input, size_t size) {
     double acc = 1;
-    for (size_t i = 0; i < input.size(); i++) {
-        acc *= input.at(i);
+    for (size_t i = 0; i < size; i++) {
+        acc *= input[i];
     }
     return acc;
 }
 
+void MultiplyFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFold(Opcode::Multiply, size);
+}
+
 Entry* MultiplyFunction::getDerivative() {
-    if (input.size() == 2) {
-        if (input.at(0)->isVariable() && input.at(1)->isVariable()) {
-            Operator* mul1 = new MultiplyFunction();
-            mul1->addInput(input.at(0)->getDerivative());
-            mul1->addInput(input.at(1)->copy());
-            Operator* mul2 = new MultiplyFunction();
-            mul2->addInput(input.at(0)->copy());
-            mul2->addInput(input.at(1)->getDerivative());
-            Operator* add = new AddFunction();
-            add->addInput(mul1);
-            add->addInput(mul2);
-            return add;
-        } else if (input.at(0)->isVariable()) {
-            Operator* mul = new MultiplyFunction();
-            mul->addInput(input.at(0)->getDerivative());
-            mul->addInput(input.at(1)->copy());
-            return mul;
-        } else if (input.at(1)->isVariable()) {
-            Operator* mul = new MultiplyFunction();
-            mul->addInput(input.at(1)->getDerivative());
-            mul->addInput(input.at(0)->copy());
-            return mul;
+    // product rule over any number of factors, constant factors only get copied
+    std::vector<Entry*> terms;
+    for (size_t i = 0; i < input.size(); i++) {
+        if (!input.at(i)->isVariable()) {
+            continue;
+        }
+        Operator* mul = new MultiplyFunction();
+        mul->addInput(input.at(i)->getDerivative());
+        for (size_t j = 0; j < input.size(); j++) {
+            if (j != i) {
+                mul->addInput(input.at(j)->copy());
+            }
         }
+        terms.push_back(mul);
+    }
+
+    if (terms.empty()) {
         return new ConstantEntry(0);
+    } else if (terms.size() == 1) {
+        return terms[0];
     }
-    return new ConstantEntry(0);
+    Operator* add = new AddFunction();
+    for (size_t i = 0; i < terms.size(); i++) {
+        add->addInput(terms[i]);
+    }
+    return add;
 }
 
 bool MultiplyFunction::hasPriority() {
@@ -338,8 +461,12 @@ size_t DivideFunction::acceptedArgsNumber() {
     return 2;
 }
 
-double DivideFunction::function(std::vector<double> input) {
-    return input.at(0) / input.at(1);
+double DivideFunction::function(const double* input, size_t) {
+    return input[0] / input[1];
+}
+
+void DivideFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Divide, 2, size);
 }
 
 Entry* DivideFunction::getDerivative() {
@@ -394,8 +521,12 @@ size_t PowerFunction::acceptedArgsNumber() {
     return 2;
 }
 
-double PowerFunction::function(std::vector<double> input) {
-    return powf(input.at(0), input.at(1));
+double PowerFunction::function(const double* input, size_t) {
+    return Kernel<double>::pow(input[0], input[1]);
+}
+
+void PowerFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Power, 2, size);
 }
 
 Entry* PowerFunction::getDerivative() {
@@ -449,10 +580,14 @@ std::string SignFunction::getFunctionName() {
     return "sign";
 };
 
-double SignFunction::function(std::vector<double> input) {
-    return (0 < input.at(0)) - (input.at(0) < 0);
+double SignFunction::function(const double* input, size_t) {
+    return Kernel<double>::sign(input[0]);
 };
 
+void SignFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Sign, 1, size);
+}
+
 Entry* SignFunction::getDerivative() {
     return new ConstantEntry(0);
 };
@@ -461,8 +596,12 @@ std::string AbsFunction::getFunctionName() {
     return "abs";
 }
 
-double AbsFunction::function(std::vector<double> input) {
-    return abs(input.at(0));
+double AbsFunction::function(const double* input, size_t) {
+    return Kernel<double>::abs(input[0]);
+}
+
+void AbsFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Abs, 1, size);
 }
 
 Entry* AbsFunction::getDerivative() {
@@ -479,8 +618,12 @@ std::string SqrtFunction::getFunctionName() {
     return "sqrt";
 }
 
-double SqrtFunction::function(std::vector<double> input) {
-    return sqrt(input.at(0));
+double SqrtFunction::function(const double* input, size_t) {
+    return Kernel<double>::sqrt(input[0]);
+}
+
+void SqrtFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Sqrt, 1, size);
 }
 
 Entry* SqrtFunction::getDerivative() {
@@ -495,8 +638,12 @@ std::string SinFunction::getFunctionName() {
     return "sin";
 }
 
-double SinFunction::function(std::vector<double> input) {
-    return sinf(input.at(0));
+double SinFunction::function(const double* input, size_t) {
+    return Kernel<double>::sin(input[0]);
+}
+
+void SinFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Sin, 1, size);
 }
 
 Entry* SinFunction::getDerivative() {
@@ -513,8 +660,12 @@ std::string CosFunction::getFunctionName() {
     return "cos";
 }
 
-double CosFunction::function(std::vector<double> input) {
-    return cosf(input.at(0));
+double CosFunction::function(const double* input, size_t) {
+    return Kernel<double>::cos(input[0]);
+}
+
+void CosFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Cos, 1, size);
 }
 
 Entry* CosFunction::getDerivative() {
@@ -534,8 +685,12 @@ std::string TanFunction::getFunctionName() {
     return "tan";
 }
 
-double TanFunction::function(std::vector<double> input) {
-    return tanf(input.at(0));
+double TanFunction::function(const double* input, size_t) {
+    return Kernel<double>::tan(input[0]);
+}
+
+void TanFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Tan, 1, size);
 }
 
 Entry* TanFunction::getDerivative() {
@@ -555,8 +710,12 @@ std::string CotFunction::getFunctionName() {
     return "cot";
 }
 
-double CotFunction::function(std::vector<double> input) {
-    return 1 / tanf(input.at(0));
+double CotFunction::function(const double* input, size_t) {
+    return Kernel<double>::cot(input[0]);
+}
+
+void CotFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Cot, 1, size);
 }
 
 Entry* CotFunction::getDerivative() {
@@ -579,8 +738,12 @@ std::string LnFunction::getFunctionName() {
     return "ln";
 }
 
-double LnFunction::function(std::vector<double> input) {
-    return logf(input.at(0));
+double LnFunction::function(const double* input, size_t) {
+    return Kernel<double>::ln(input[0]);
+}
+
+void LnFunction::compileFunction(CompiledEquation& program, size_t size) {
+    program.emitFunction(Opcode::Ln, 1, size);
 }
 
 Entry* LnFunction::getDerivative() {
@@ -599,13 +762,21 @@ size_t LogFunction::acceptedArgsNumber() {
     return 2;
 }
 
-double LogFunction::function(std::vector<double> input) {
-    if (input.size() == 2) {
-        return logf(input.at(1)) / logf(input.at(0));
+double LogFunction::function(const double* input, size_t size) {
+    if (size == 2) {
+        return Kernel<double>::log(input[0], input[1]);
     }
     return 0;
 }
 
+void LogFunction::compileFunction(CompiledEquation& program, size_t size) {
+    if (size == 2) {
+        program.emit(Opcode::Log);
+    } else {
+        program.emitFunction(Opcode::Constant, 0, size);
+    }
+}
+
 Entry* LogFunction::getDerivative() {
     Operator* div = new DivideFunction();
     div->addInput(input.at(1)->getDerivative());
@@ -26,13 +26,31 @@ public:
     Tuple getAt(int index);
 };
 
+class CompiledEquation;
+class NodeArena;
+class Polynomial;
+
 // Main class holding equation tree
 class Entry {
 public:
     virtual ~Entry() = DEFAULT;
 
+    // Nodes go into the current NodeArena if there is one, otherwise to the heap
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer);
+
     // Traverse tree and evaluate function value at x
     virtual Entry* evaluate(double x) { return nullptr; }
+    // Traverse tree and calculate function value at x without allocating anything
+    virtual double calculate(double) { return 0; }
+    // calculate function values for n points at once
+    virtual void evaluateBatch(const double* xs, double* ys, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            ys[i] = calculate(xs[i]);
+        }
+    }
+    // lower the tree into postfix instructions of a compiled equation
+    virtual void compile(CompiledEquation& program);
     // get numberic value of constant or variable entries
     virtual double getValue() { return 0; }
     // full copy of the tree
@@ -41,6 +59,8 @@ public:
     virtual bool isVariable() { return false; }
     // get analyticaly derivative
     virtual Entry* getDerivative() { return nullptr; }
+    // canonical node shared by all structurally identical subtrees, see NodeArena::intern
+    virtual Entry* intern(NodeArena&) { return this; }
     virtual std::string to_string(Entry const&) { return "Entry base"; }
 };
 
@@ -48,6 +68,13 @@ class EquationHolder {
 public:
     Entry* equation;
     Entry* derivative;
+    // owns all nodes of equation and derivative
+    NodeArena* arena = nullptr;
+    // equation as dense coefficients when it is a polynomial
+    Polynomial* polynomial = nullptr;
+    // compiled forms used for plotting and solving
+    CompiledEquation* compiledEquation = nullptr;
+    CompiledEquation* compiledDerivative = nullptr;
     bool windowReady = false;
 };
 
@@ -64,12 +91,18 @@ public:
 
     Entry* evaluate(double x) override;
 
+    double calculate(double x) override;
+
+    void compile(CompiledEquation& program) override;
+
     Entry* copy() override;
 
     bool isVariable() override;
 
     Entry* getDerivative() override;
 
+    Entry* intern(NodeArena& arena) override;
+
     std::string to_string(Entry const&) override;
 };
 
@@ -81,12 +114,18 @@ public:
 
     Entry* evaluate(double x) override;
 
+    double calculate(double x) override;
+
+    void compile(CompiledEquation& program) override;
+
     Entry* copy() override;
 
     bool isVariable() override;
 
     Entry* getDerivative() override;
 
+    Entry* intern(NodeArena& arena) override;
+
     std::string to_string(Entry const&) override;
 };
 
@@ -102,12 +141,18 @@ public:
 
     Entry* evaluate(double x) override;
 
+    double calculate(double x) override;
+
+    void compile(CompiledEquation& program) override;
+
     Entry* copy() override;
 
     bool isVariable() override;
 
     Entry* getDerivative() override;
 
+    Entry* intern(NodeArena& arena) override;
+
     std::string to_string(Entry const&) override;
 };
 
@@ -117,11 +162,7 @@ protected:
     std::vector<Entry*> input;
 
 public:
-    ~Operator() override {
-        for (auto p : input) {
-            delete p;
-        }
-    }
+    ~Operator() override;
 
     virtual std::string getFunctionName() {
         return "";
@@ -129,10 +170,13 @@ public:
 
     std::string getType() override;
 
-    virtual double function(std::vector<double> input) {
+    virtual double function(const double*, size_t) {
         return 0;
     }
 
+    // emit instruction computing function from `size` inputs already on the stack
+    virtual void compileFunction(CompiledEquation& program, size_t size);
+
     // minimum number of arguments accepted (default 1)
     virtual size_t acceptedArgsNumber() {
         return 1;
@@ -146,12 +190,20 @@ public:
 
     void addInput(Entry* entry);
 
+    const std::vector<Entry*>& getInputs();
+
     double getValue() override;
 
     Entry* evaluate(double x) override;
 
+    double calculate(double x) override;
+
+    void compile(CompiledEquation& program) override;
+
     Entry* copy() override;
 
+    Entry* intern(NodeArena& arena) override;
+
     std::string to_string(Entry const&) override;
 };
 
@@ -160,7 +212,9 @@ class AddFunction : public Operator {
 
     size_t acceptedArgsNumber() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -168,7 +222,9 @@ class AddFunction : public Operator {
 class SubtractFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -178,7 +234,9 @@ class MultiplyFunction : public Operator {
 
     size_t acceptedArgsNumber() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 
@@ -190,7 +248,9 @@ class DivideFunction : public Operator {
 
     size_t acceptedArgsNumber() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 
@@ -202,7 +262,9 @@ class PowerFunction : public Operator {
 
     size_t acceptedArgsNumber() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -210,7 +272,9 @@ class PowerFunction : public Operator {
 class AbsFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -218,7 +282,9 @@ class AbsFunction : public Operator {
 class SignFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -226,7 +292,9 @@ class SignFunction : public Operator {
 class SqrtFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -234,7 +302,9 @@ class SqrtFunction : public Operator {
 class SinFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -242,7 +312,9 @@ class SinFunction : public Operator {
 class CosFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -250,7 +322,9 @@ class CosFunction : public Operator {
 class TanFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -258,7 +332,9 @@ class TanFunction : public Operator {
 class CotFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -266,7 +342,9 @@ class CotFunction : public Operator {
 class LnFunction : public Operator {
     std::string getFunctionName() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
@@ -276,7 +354,9 @@ class LogFunction : public Operator {
 
     size_t acceptedArgsNumber() override;
 
-    double function(std::vector<double> input) override;
+    double function(const double* input, size_t size) override;
+
+    void compileFunction(CompiledEquation& program, size_t size) override;
 
     Entry* getDerivative() override;
 };
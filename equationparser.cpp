@@ -256,7 +256,7 @@ math::Entry* EquationParser::parseEquation(std::string input, int depth) {
 	    } else if (input.at(start) == 'x') {
 		return new math::VariableEntry();
 	    } else {
-		return new math::ConstantEntry(std::stof(input));
+		return new math::ConstantEntry(std::stod(input));
 	    }
 	}
     }
@@ -0,0 +1,304 @@
+#include "equationsimplifier.h"
+
+#include <cmath>
+
+using math::ConstantEntry;
+using math::Entry;
+using math::Operator;
+
+namespace {
+bool isConstant(Entry* entry, double& value) {
+    ConstantEntry* constant = dynamic_cast<ConstantEntry*>(entry);
+    if (constant == nullptr || constant->isVariable()) {
+        return false;
+    }
+    value = constant->getValue();
+    return true;
+}
+
+bool isConstantEqual(Entry* entry, double value) {
+    double constant;
+    return isConstant(entry, constant) && constant == value;
+}
+
+bool isInteger(double value) {
+    return std::floor(value) == value && std::abs(value) < 1e15;
+}
+
+// Type of operator, empty for leaves
+std::string typeOf(Entry* entry) {
+    Operator* op = dynamic_cast<Operator*>(entry);
+    if (op == nullptr) {
+        return "";
+    }
+    return op->getType();
+}
+
+Operator* makeOperator(const std::string& type, const std::vector<Entry*>& inputs) {
+    Operator* op = dynamic_cast<Operator*>(Factory::makeRaw(type));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        op->addInput(inputs[i]);
+    }
+    return op;
+}
+
+Operator* makeOperator(const std::string& type, Entry* a, Entry* b) {
+    std::vector<Entry*> inputs;
+    inputs.push_back(a);
+    inputs.push_back(b);
+    return makeOperator(type, inputs);
+}
+
+Entry* negate(Entry* entry) {
+    double value;
+    if (isConstant(entry, value)) {
+        return new ConstantEntry(-value);
+    }
+    if (typeOf(entry) == "sub") {
+        const std::vector<Entry*>& inputs = dynamic_cast<Operator*>(entry)->getInputs();
+        if (inputs.size() == 1) {
+            return inputs[0];
+        }
+    }
+    return makeOperator("sub", std::vector<Entry*>(1, entry));
+}
+
+// Append inputs of nested operators of the same associative type
+void flatten(const std::string& type, const std::vector<Entry*>& inputs, std::vector<Entry*>& result) {
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (typeOf(inputs[i]) == type) {
+            flatten(type, dynamic_cast<Operator*>(inputs[i])->getInputs(), result);
+        } else {
+            result.push_back(inputs[i]);
+        }
+    }
+}
+
+Entry* simplifyAdd(const std::vector<Entry*>& inputs) {
+    std::vector<Entry*> terms;
+    flatten("add", inputs, terms);
+
+    double sum = 0;
+    std::vector<Entry*> rest;
+    for (size_t i = 0; i < terms.size(); i++) {
+        double value;
+        if (isConstant(terms[i], value)) {
+            sum += value;
+        } else {
+            rest.push_back(terms[i]);
+        }
+    }
+    if (sum != 0 || rest.empty()) {
+        rest.push_back(new ConstantEntry(sum));
+    }
+    if (rest.size() == 1) {
+        return rest[0];
+    }
+    return makeOperator("add", rest);
+}
+
+Entry* simplifyMul(const std::vector<Entry*>& inputs) {
+    std::vector<Entry*> factors;
+    flatten("mul", inputs, factors);
+
+    // factors as base ^ exponent, equal bases with integer exponents are merged
+    double product = 1;
+    std::vector<Entry*> bases;
+    std::vector<double> exponents;
+    for (size_t i = 0; i < factors.size(); i++) {
+        double value;
+        if (isConstant(factors[i], value)) {
+            product *= value;
+            continue;
+        }
+        Entry* base = factors[i];
+        double exponent = 1;
+        if (typeOf(base) == "pow") {
+            const std::vector<Entry*>& power = dynamic_cast<Operator*>(base)->getInputs();
+            if (power.size() == 2 && isConstant(power[1], value) && isInteger(value)) {
+                base = power[0];
+                exponent = value;
+            }
+        }
+        bool merged = false;
+        for (size_t j = 0; j < bases.size() && isInteger(exponent); j++) {
+            if (isInteger(exponents[j]) && EquationSimplifier::isEqual(bases[j], base)) {
+                exponents[j] += exponent;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            bases.push_back(base);
+            exponents.push_back(exponent);
+        }
+    }
+    if (product == 0) {
+        return new ConstantEntry(0);
+    }
+
+    std::vector<Entry*> rest;
+    if (product != 1 && product != -1) {
+        rest.push_back(new ConstantEntry(product));
+    }
+    for (size_t i = 0; i < bases.size(); i++) {
+        if (exponents[i] == 1) {
+            rest.push_back(bases[i]);
+        } else if (exponents[i] != 0) {
+            rest.push_back(makeOperator("pow", bases[i], new ConstantEntry(exponents[i])));
+        }
+    }
+
+    Entry* result;
+    if (rest.empty()) {
+        return new ConstantEntry(product);
+    } else if (rest.size() == 1) {
+        result = rest[0];
+    } else {
+        result = makeOperator("mul", rest);
+    }
+    return product == -1 ? negate(result) : result;
+}
+
+Entry* simplifySub(const std::vector<Entry*>& inputs) {
+    if (inputs.size() == 1) {
+        return negate(inputs[0]);
+    }
+    if (isConstantEqual(inputs[1], 0)) {
+        return inputs[0];
+    }
+    if (isConstantEqual(inputs[0], 0)) {
+        return negate(inputs[1]);
+    }
+    if (EquationSimplifier::isEqual(inputs[0], inputs[1])) {
+        return new ConstantEntry(0);
+    }
+    return nullptr;
+}
+
+Entry* simplifyDiv(const std::vector<Entry*>& inputs) {
+    double value;
+    if (isConstantEqual(inputs[1], 1)) {
+        return inputs[0];
+    }
+    if (isConstantEqual(inputs[1], -1)) {
+        return negate(inputs[0]);
+    }
+    // 0 / 0 stays
+    if (isConstantEqual(inputs[0], 0) && !(isConstant(inputs[1], value) && value == 0)) {
+        return new ConstantEntry(0);
+    }
+    return nullptr;
+}
+
+Entry* simplifyPow(const std::vector<Entry*>& inputs) {
+    double exponent;
+    if (!isConstant(inputs[1], exponent)) {
+        if (isConstantEqual(inputs[0], 1)) {
+            return new ConstantEntry(1);
+        }
+        return nullptr;
+    }
+    if (exponent == 0) {
+        return new ConstantEntry(1);
+    }
+    if (exponent == 1) {
+        return inputs[0];
+    }
+    // (a ^ b) ^ n = a ^ (b * n) for integer b and n, a fractional b would drop the a < 0 gap from the domain
+    if (typeOf(inputs[0]) == "pow" && isInteger(exponent)) {
+        const std::vector<Entry*>& power = dynamic_cast<Operator*>(inputs[0])->getInputs();
+        double inner;
+        if (power.size() == 2 && isConstant(power[1], inner) && isInteger(inner)) {
+            return simplifyPow(std::vector<Entry*>{power[0], new ConstantEntry(inner * exponent)});
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+EquationSimplifier::EquationSimplifier() {
+}
+
+Entry* EquationSimplifier::simplify(Entry* entry) {
+    Operator* op = dynamic_cast<Operator*>(entry);
+    if (op == nullptr) {
+        return entry;
+    }
+    const std::vector<Entry*>& original = op->getInputs();
+    if (original.size() < op->acceptedArgsNumber()) {
+        return entry;
+    }
+
+    std::vector<Entry*> inputs(original.size());
+    bool changed = false;
+    bool constant = true;
+    for (size_t i = 0; i < original.size(); i++) {
+        inputs[i] = simplify(original[i]);
+        changed = changed || inputs[i] != original[i];
+        double value;
+        constant = constant && isConstant(inputs[i], value);
+    }
+
+    Operator* result = changed ? makeOperator(op->getType(), inputs) : op;
+    if (constant) {
+        return new ConstantEntry(result->calculate(0));
+    }
+
+    std::string type = op->getType();
+    Entry* rewritten = nullptr;
+    if (type == "add") {
+        rewritten = simplifyAdd(inputs);
+    } else if (type == "mul") {
+        rewritten = simplifyMul(inputs);
+    } else if (type == "sub") {
+        rewritten = simplifySub(inputs);
+    } else if (type == "div" && inputs.size() == 2) {
+        rewritten = simplifyDiv(inputs);
+    } else if (type == "pow" && inputs.size() == 2) {
+        rewritten = simplifyPow(inputs);
+    }
+    return rewritten != nullptr ? rewritten : result;
+}
+
+size_t EquationSimplifier::countNodes(Entry* entry) {
+    Operator* op = dynamic_cast<Operator*>(entry);
+    if (op == nullptr) {
+        return 1;
+    }
+    size_t count = 1;
+    const std::vector<Entry*>& inputs = op->getInputs();
+    for (size_t i = 0; i < inputs.size(); i++) {
+        count += countNodes(inputs[i]);
+    }
+    return count;
+}
+
+bool EquationSimplifier::isEqual(Entry* a, Entry* b) {
+    if (a == b) {
+        return true;
+    }
+    double valueA, valueB;
+    if (isConstant(a, valueA)) {
+        return isConstant(b, valueB) && valueA == valueB;
+    }
+    if (dynamic_cast<math::VariableEntry*>(a) != nullptr) {
+        return dynamic_cast<math::VariableEntry*>(b) != nullptr;
+    }
+    Operator* opA = dynamic_cast<Operator*>(a);
+    Operator* opB = dynamic_cast<Operator*>(b);
+    if (opA == nullptr || opB == nullptr || opA->getType() != opB->getType()) {
+        return false;
+    }
+    const std::vector<Entry*>& inputsA = opA->getInputs();
+    const std::vector<Entry*>& inputsB = opB->getInputs();
+    if (inputsA.size() != inputsB.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < inputsA.size(); i++) {
+        if (!isEqual(inputsA[i], inputsB[i])) {
+            return false;
+        }
+    }
+    return true;
+}
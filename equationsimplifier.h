@@ -0,0 +1,21 @@
+#ifndef EQUATIONSIMPLIFIER_H
+#define EQUATIONSIMPLIFIER_H
+
+#include "equation.h"
+
+// Rewrite rules shrinking equation trees, mainly the output of getDerivative
+class EquationSimplifier {
+public:
+    EquationSimplifier();
+
+    // Constant folding, neutral and absorbing elements, flattening of nested add and mul,
+    // collecting integer powers of the same base. Input is not modified, untouched subtrees
+    // are shared with the result.
+    static math::Entry* simplify(math::Entry* entry);
+    // Number of nodes, shared subtrees are counted every time they are used
+    static size_t countNodes(math::Entry* entry);
+    // Structural equality of two trees
+    static bool isEqual(math::Entry* a, math::Entry* b);
+};
+
+#endif  // EQUATIONSIMPLIFIER_H
@@ -1,101 +1,551 @@
 #include "equationsolver.h"
+#include "compiledequation.h"
 #include "equationparser.h"
+#include "polynomial.h"
+#include "taylor.h"
+#include "workstealingpool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+// Root search splits every interval into this many chunks per thread
+#define ROOT_SEARCH_CHUNKS_PER_THREAD 4
+// Halves of boxes bisected at most this many times are searched as separate tasks
+#define ROOT_SEARCH_SPAWN_DEPTH 10
+// ITP truncation constant k1, relative to the width of the starting bracket
+#define ITP_TRUNCATION 0.2
+// Steps ITP may spend beyond plain bisection before falling back to it
+#define ITP_SLACK_STEPS 1
+// Highest order of Householder iteration, 2 is Halley's method
+#define HOUSEHOLDER_MAX_ORDER 4
+// Automatic iteration gives up after this many steps without getting closer to zero
+#define AUTO_ITERATION_PATIENCE 20
+// Polynomial roots closer to the real axis than this, relative to their size, are real if p vanishes there
+#define POLYNOMIAL_REAL_TOLERANCE 1e-4
+// Krawczyk steps that shrink a box to less than this fraction of its width are repeated instead of bisecting
+#define KRAWCZYK_CONTRACTION 0.5
+// Largest root multiplicity the modified Newton step is scaled by
+#define MULTIPLE_ROOT_MAX_MULTIPLICITY 16
 
 EquationSolver::EquationSolver() {
 }
 
-math::Interval* EquationSolver::splitInterval(math::Entry* function, math::Interval* entredInterval, double step, int& iterations) {
-    math::Interval* result = new math::Interval();
-    iterations = 0;
+namespace {
+// Subinterval of the branch and bound search with f and f' at both ends
+struct Box {
+    double a, b;
+    double fa, fb;
+    double da, db;
+    // number of bisections from the first box
+    int depth;
+};
 
-    for (int i = 0; i < entredInterval->size(); i++) {
-        math::Tuple entry = entredInterval->getAt(i);
-        for (double x = entry.a; x < entry.b; x += step) {
-            double fa = function->evaluate(x)->getValue();
-            double fb = function->evaluate(x + step)->getValue();
-            if (sign(fa) * sign(fb) == -1) {
-                result->addEntry(math::Tuple(x, x + step));
-            }
-            iterations++;
+bool isBracket(double fa, double fb) {
+    return sign(fa) * sign(fb) == -1;
+}
+
+// Bracket of a point where f is exactly zero
+math::Tuple around(double x, double resolution) {
+    return math::Tuple(x - resolution / 2, x + resolution / 2);
+}
+
+// Narrow a sign change of a monotonic box down to resolution with plain bisection
+math::Tuple narrowBracket(math::Entry* function, double a, double b, double fa, double resolution, int& iterations) {
+    while (b - a > resolution) {
+        double m = a + (b - a) / 2;
+        if (m <= a || m >= b) {
+            break;
+        }
+        double fm = function->calculate(m);
+        iterations++;
+        if (fm == 0) {
+            return around(m, resolution);
+        }
+        if (sign(fm) == sign(fa)) {
+            a = m;
+            fa = fm;
+        } else {
+            b = m;
         }
     }
+    return math::Tuple(a, b);
+}
 
-    return result;
+// Box between the sample points i and i + 1. Exact zeros at b, and at a for the first box of an interval, are reported
+// here as the branch step never looks at the ends.
+Box makeBox(const std::vector<double>& xs, const std::vector<double>& fs, const std::vector<double>& ds, size_t i, double resolution, std::vector<math::Tuple>& brackets) {
+    Box box = {xs[i], xs[i + 1], fs[i], fs[i + 1], ds[i], ds[i + 1], 0};
+    if (i == 0 && box.fa == 0) {
+        brackets.push_back(around(box.a, resolution));
+    }
+    if (box.fb == 0) {
+        brackets.push_back(around(box.b, resolution));
+    }
+    return box;
 }
 
-bool EquationSolver::solveUsingSimpleItterations(math::Entry* equation, math::Entry* cFunc, double a, double b, int precision, double& root, int& iterationCount) {
-    math::Operator* mul = new math::MultiplyFunction();
-    mul->addInput(cFunc);
-    mul->addInput(equation);
+// One branch and bound step: drops the box, reports its bracket, or returns true with the halves to search next
+bool branch(math::CompiledEquation* function, const Box& box, double resolution, std::vector<math::Tuple>& brackets, Box& left, Box& right, int& iterations) {
+    math::Bounds x(box.a, box.b);
+    math::Bounds derivative;
+    math::Bounds range = function->calculateBoundsWithDerivative(x, derivative);
+    double m = box.a + (box.b - box.a) / 2;
+    double dm;
+    double fm = function->calculateWithDerivative(m, dm);
+    iterations += 2;
+
+    bool defined = std::isfinite(box.fa) && std::isfinite(fm) && std::isfinite(box.fb);
+    bool bounded = std::isfinite(range.lo) && std::isfinite(range.hi);
+    bool monotonic = bounded && defined && !derivative.contains(0);
+    // mean value form f(m) + f'(x) (x - m) is much tighter than the plain enclosure on narrow boxes
+    if (defined && std::isfinite(derivative.lo) && std::isfinite(derivative.hi)) {
+        math::Bounds meanValue = math::Bounds(fm) + derivative * (x - math::Bounds(m));
+        range = math::Bounds(std::max(range.lo, meanValue.lo), std::min(range.hi, meanValue.hi));
+    }
+    if (range.isEmpty() || !range.contains(0)) {
+        return false;
+    }
 
-    math::Operator* auxFunc = new math::AddFunction();
-    auxFunc->addInput(new math::VariableEntry());
-    auxFunc->addInput(mul);
+    if (monotonic) {
+        if (fm == 0) {
+            brackets.push_back(around(m, resolution));
+        } else if (isBracket(box.fa, fm)) {
+            brackets.push_back(narrowBracket(function, box.a, m, box.fa, resolution, iterations));
+        } else if (isBracket(fm, box.fb)) {
+            brackets.push_back(narrowBracket(function, m, box.b, fm, resolution, iterations));
+        }
+        return false;
+    }
 
-    double xk = a;
-    double xk1 = -1;
-    int iterations = 0;
-    while (true) {
-        if (iterations > 100000) {
+    if (box.b - box.a <= resolution || m <= box.a || m >= box.b) {
+        // poles and jumps look like sign changes, but are never bounded
+        if (!bounded) {
             return false;
         }
-        xk1 = auxFunc->evaluate(xk)->getValue();
-        if (abs(xk1 - xk) < pow(10, -precision)) {
-            root = xk1;
-            iterationCount = iterations;
-            return true;
+        if (isBracket(box.fa, box.fb)) {
+            brackets.push_back(math::Tuple(box.a, box.b));
+        } else if (isBracket(box.da, box.db) && sign(box.fa) * sign(box.fb) == 1) {
+            // f touches zero between a and b
+            brackets.push_back(math::Tuple(box.a, box.b));
         }
-        xk = xk1;
-        iterations++;
+        return false;
     }
 
-    return false;
+    if (fm == 0) {
+        brackets.push_back(around(m, resolution));
+    }
+    left = {box.a, m, box.fa, fm, box.da, dm, box.depth + 1};
+    right = {m, box.b, fm, box.fb, dm, box.db, box.depth + 1};
+    return true;
 }
 
-bool EquationSolver::solveUsingFastItterations(math::Entry* equation, math::Entry* cFunc, double a, double b, int precision, double& root, int& iterationCount) {
-    double xk = a;
-    double xk1 = -1;
-    int iterations = 0;
+// exact zeros at split points are reported before the brackets left of them
+void sortBrackets(std::vector<math::Tuple>& brackets) {
+    std::sort(brackets.begin(), brackets.end(), [](const math::Tuple& first, const math::Tuple& second) { return first.a < second.a; });
+}
+
+// Workers finish in any order, roots are listed in order of their brackets
+void sortRoots(std::vector<EquationSolver::Root>& roots) {
+    std::sort(roots.begin(), roots.end(), [](const EquationSolver::Root& first, const EquationSolver::Root& second) { return first.bracket.a < second.bracket.a; });
+}
+
+bool isFinite(const math::Bounds& bounds) {
+    return std::isfinite(bounds.lo) && std::isfinite(bounds.hi);
+}
+
+// Enclosure of f' over x, from the symbolic derivative when there is one
+math::Bounds derivativeBounds(math::CompiledEquation* function, math::CompiledEquation* derivative, const math::Bounds& x) {
+    if (derivative != nullptr) {
+        return derivative->calculateBounds(x);
+    }
+    math::Bounds slope;
+    function->calculateBoundsWithDerivative(x, slope);
+    return slope;
+}
+
+// Krawczyk steps on one box until it is proven to hold a single root, to hold none, or stops shrinking.
+// Returns true with the halves to search next in the last case
+bool verifyBox(math::CompiledEquation* function, math::CompiledEquation* derivative, math::Tuple box, double resolution, EquationSolver::Verification& found, math::Tuple& left, math::Tuple& right) {
+    double a = box.a;
+    double b = box.b;
+    // once a box has a single root, so do the smaller ones holding it
+    bool proven = false;
     while (true) {
-        if (iterations > 100000) {
+        found.boxes++;
+        math::Bounds x(a, b);
+        math::Bounds range = function->calculateBounds(x);
+        if (!range.contains(0)) {
+            found.rootFree.push_back(math::Tuple(a, b));
             return false;
         }
-        double cx = cFunc->evaluate(xk)->getValue();
-        double fx = equation->evaluate(xk)->getValue();
-        xk1 = xk - cx * fx * fx / (fx - equation->evaluate(xk - cx * fx)->getValue());
 
-	if (abs(xk1 - xk) < pow(10, -precision)) {
-	    root = xk1;
-	    iterationCount = iterations;
-	    return true;
-	}
-	xk = xk1;
-	iterations++;
+        bool shrank = false;
+        math::Bounds slope = derivativeBounds(function, derivative, x);
+        if (isFinite(slope) && !slope.contains(0)) {
+            // f is strictly monotonic, a root at an end is the only one. Roots on split points end up here, outward
+            // rounding never gives them an exact zero enclosure, so the plain value has to do
+            if (function->calculate(a) == 0) {
+                found.roots.push_back(math::Tuple(a, a));
+                found.rootFree.push_back(math::Tuple(a, b));
+                return false;
+            }
+            if (function->calculate(b) == 0) {
+                found.roots.push_back(math::Tuple(b, b));
+                found.rootFree.push_back(math::Tuple(a, b));
+                return false;
+            }
+            math::Bounds fa = function->calculateBounds(math::Bounds(a));
+            math::Bounds fb = function->calculateBounds(math::Bounds(b));
+            proven = proven || (fa.hi < 0 && fb.lo > 0) || (fa.lo > 0 && fb.hi < 0);
+        }
+        double m = x.middle();
+        double y = 1 / slope.middle();
+        if (isFinite(slope) && std::isfinite(y) && y != 0) {
+            // K(x) = m - y f(m) + (1 - y f'(x)) (x - m) holds every root in x, by the mean value theorem
+            math::Bounds k = math::Bounds(m) - math::Bounds(y) * function->calculateBounds(math::Bounds(m)) + (math::Bounds(1) - math::Bounds(y) * slope) * (x - math::Bounds(m));
+            if (!k.isEmpty()) {
+                double lo = std::max(a, k.lo);
+                double hi = std::min(b, k.hi);
+                if (lo > hi) {
+                    found.rootFree.push_back(math::Tuple(a, b));
+                    return false;
+                }
+                // K(x) strictly inside x proves x holds exactly one root
+                proven = proven || (k.lo > a && k.hi < b);
+                if (lo > a) {
+                    found.rootFree.push_back(math::Tuple(a, lo));
+                }
+                if (hi < b) {
+                    found.rootFree.push_back(math::Tuple(hi, b));
+                }
+                shrank = hi - lo <= KRAWCZYK_CONTRACTION * (b - a);
+                a = lo;
+                b = hi;
+            }
+        }
+
+        bool small = b - a <= resolution;
+        if (proven && small) {
+            found.roots.push_back(math::Tuple(a, b));
+            return false;
+        }
+        if (shrank) {
+            continue;
+        }
+        m = a + (b - a) / 2;
+        if (small || m <= a || m >= b) {
+            (proven ? found.roots : found.undecided).push_back(math::Tuple(a, b));
+            return false;
+        }
+        // halves of a proven box are proven again, the one without the root is dropped
+        left = math::Tuple(a, m);
+        right = math::Tuple(m, b);
+        return true;
     }
+}
 
-    return false;
+// Sort and join overlapping or touching regions
+void mergeRegions(std::vector<math::Tuple>& regions) {
+    sortBrackets(regions);
+    std::vector<math::Tuple> merged;
+    for (const math::Tuple& region : regions) {
+        if (!merged.empty() && region.a <= merged.back().b) {
+            merged.back().b = std::max(merged.back().b, region.b);
+        } else {
+            merged.push_back(region);
+        }
+    }
+    regions.swap(merged);
+}
+}  // namespace
+
+std::vector<EquationSolver::Root> EquationSolver::findRoots(math::CompiledEquation* function, math::Interval* entredInterval, double resolution, const Method& method, int precision, int& searchIterations, size_t threadCount) {
+    WorkStealingPool pool(threadCount);
+    std::mutex mutex;
+    std::vector<Root> roots;
+    std::atomic<int> iterations(0);
+
+    // brackets are refined by the worker that found them, while other boxes are still searched
+    auto refine = [&](std::vector<math::Tuple>& brackets) {
+        for (const math::Tuple& bracket : brackets) {
+            double root;
+            int count = 0;
+            bool found;
+            if (isBracket(function->calculate(bracket.a), function->calculate(bracket.b))) {
+                found = method(bracket.a, bracket.b, root, count);
+            } else {
+                // touching roots and exact zeros of even multiplicity keep the sign of f on both ends, a bracketing
+                // method would drop them. The root is where f' changes sign inside, Newton must not wander off
+                found = solveUsingMultipleRootNewton(function, bracket.a, bracket.b, precision, root, count) && root >= bracket.a && root <= bracket.b;
+            }
+            if (found) {
+                std::lock_guard<std::mutex> lock(mutex);
+                roots.push_back(Root(bracket, root, count));
+            }
+        }
+        brackets.clear();
+    };
+
+    std::function<void(Box)> search = [&](Box box) {
+        std::vector<Box> pending(1, box);
+        std::vector<math::Tuple> brackets;
+        int count = 0;
+        while (!pending.empty()) {
+            Box current = pending.back();
+            pending.pop_back();
+            Box left, right;
+            if (branch(function, current, resolution, brackets, left, right, count)) {
+                // halves of big boxes become tasks that idle workers can steal
+                if (right.depth <= ROOT_SEARCH_SPAWN_DEPTH) {
+                    pool.submit([&search, right] { search(right); });
+                } else {
+                    pending.push_back(right);
+                }
+                pending.push_back(left);
+            }
+            refine(brackets);
+        }
+        iterations += count;
+    };
+
+    size_t chunks = pool.threadCount() * ROOT_SEARCH_CHUNKS_PER_THREAD;
+    // neighbouring chunks share their ends, every end is evaluated once in one batch before the chunks are searched
+    std::vector<std::vector<double>> xs(entredInterval->size()), fs(entredInterval->size()), ds(entredInterval->size());
+    for (int i = 0; i < entredInterval->size(); i++) {
+        math::Tuple entry = entredInterval->getAt(i);
+        xs[i].resize(chunks + 1);
+        fs[i].resize(chunks + 1);
+        ds[i].resize(chunks + 1);
+        for (size_t j = 0; j <= chunks; j++) {
+            xs[i][j] = j == chunks ? entry.b : entry.a + (entry.b - entry.a) * j / chunks;
+        }
+        function->evaluateBatchWithDerivative(xs[i].data(), fs[i].data(), ds[i].data(), chunks + 1);
+        iterations += chunks + 1;
+        for (size_t j = 0; j < chunks; j++) {
+            pool.submit([&, i, j] {
+                std::vector<math::Tuple> brackets;
+                Box box = makeBox(xs[i], fs[i], ds[i], j, resolution, brackets);
+                refine(brackets);
+                search(box);
+            });
+        }
+    }
+    pool.wait();
+
+    sortRoots(roots);
+    searchIterations = iterations;
+    return roots;
+}
+
+EquationSolver::Verification EquationSolver::verifyRoots(math::CompiledEquation* function, math::CompiledEquation* derivative, math::Interval* entredInterval, double resolution, size_t threadCount) {
+    WorkStealingPool pool(threadCount);
+    std::mutex mutex;
+    Verification result;
+    std::atomic<int> boxes(0);
+
+    // boxes are independent, every task collects its findings locally and hands them over once
+    std::function<void(math::Tuple, int)> search = [&](math::Tuple box, int depth) {
+        Verification found;
+        std::vector<std::pair<math::Tuple, int>> pending(1, std::make_pair(box, depth));
+        while (!pending.empty()) {
+            math::Tuple current = pending.back().first;
+            int currentDepth = pending.back().second;
+            pending.pop_back();
+            math::Tuple left(0, 0), right(0, 0);
+            if (verifyBox(function, derivative, current, resolution, found, left, right)) {
+                if (currentDepth < ROOT_SEARCH_SPAWN_DEPTH) {
+                    pool.submit([&search, right, currentDepth] { search(right, currentDepth + 1); });
+                } else {
+                    pending.push_back(std::make_pair(right, currentDepth + 1));
+                }
+                pending.push_back(std::make_pair(left, currentDepth + 1));
+            }
+        }
+        boxes += found.boxes;
+        std::lock_guard<std::mutex> lock(mutex);
+        result.roots.insert(result.roots.end(), found.roots.begin(), found.roots.end());
+        result.rootFree.insert(result.rootFree.end(), found.rootFree.begin(), found.rootFree.end());
+        result.undecided.insert(result.undecided.end(), found.undecided.begin(), found.undecided.end());
+    };
+
+    size_t chunks = pool.threadCount() * ROOT_SEARCH_CHUNKS_PER_THREAD;
+    for (int i = 0; i < entredInterval->size(); i++) {
+        math::Tuple entry = entredInterval->getAt(i);
+        if (!(entry.b >= entry.a)) {
+            continue;
+        }
+        for (size_t j = 0; j < chunks; j++) {
+            double a = entry.a + (entry.b - entry.a) * j / chunks;
+            double b = j + 1 == chunks ? entry.b : entry.a + (entry.b - entry.a) * (j + 1) / chunks;
+            pool.submit([&search, a, b] { search(math::Tuple(a, b), 0); });
+        }
+    }
+    pool.wait();
+
+    // a root on the edge of two boxes is proven in both of them
+    mergeRegions(result.roots);
+    mergeRegions(result.rootFree);
+    mergeRegions(result.undecided);
+    result.boxes = boxes;
+    return result;
 }
 
-bool EquationSolver::solveUsingNewtonMethod(math::Entry* equation, math::Entry* derivative, double a, double b, int precision, double& root, int& iterationCount) {
-    math::Operator* auxFunc = new math::SubtractFunction();
-    auxFunc->addInput(new math::VariableEntry());
-    math::Operator* divide = new math::DivideFunction();
-    divide->addInput(equation);
-    divide->addInput(derivative);
-    auxFunc->addInput(divide);
+std::vector<EquationSolver::Root> EquationSolver::refineRoots(math::Interval* brackets, const Method& method) {
+    WorkStealingPool pool;
+    std::mutex mutex;
+    std::vector<Root> roots;
+    for (int i = 0; i < brackets->size(); i++) {
+        math::Tuple bracket = brackets->getAt(i);
+        pool.submit([&, bracket] {
+            double root;
+            int count = 0;
+            if (method(bracket.a, bracket.b, root, count)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                roots.push_back(Root(bracket, root, count));
+            }
+        });
+    }
+    pool.wait();
+
+    sortRoots(roots);
+    return roots;
+}
+
+math::Interval* EquationSolver::isolatePolynomialRoots(math::Polynomial* polynomial, math::Interval* entredInterval, int& iterations) {
+    math::Interval* result = new math::Interval();
+    math::SturmSequence sturm(*polynomial);
+    iterations = 0;
+
+    struct Part {
+        double a, b;
+        int changesA, changesB;
+    };
+    for (int i = 0; i < entredInterval->size(); i++) {
+        math::Tuple entry = entredInterval->getAt(i);
+        // roots are counted in (a, b], one at a itself gets a point bracket of its own
+        if (polynomial->calculate(entry.a) == 0) {
+            result->addEntry(math::Tuple(entry.a, entry.a));
+        }
+        std::vector<Part> stack;
+        stack.push_back({entry.a, entry.b, sturm.signChanges(entry.a), sturm.signChanges(entry.b)});
+        iterations += 2;
+        // the right half is pushed first, so brackets come out from left to right
+        while (!stack.empty()) {
+            Part part = stack.back();
+            stack.pop_back();
+            int count = part.changesA - part.changesB;
+            if (count <= 0) {
+                continue;
+            }
+            double m = part.a + (part.b - part.a) / 2;
+            if (count == 1 || m <= part.a || m >= part.b) {
+                result->addEntry(math::Tuple(part.a, part.b));
+                continue;
+            }
+            int changesM = sturm.signChanges(m);
+            iterations++;
+            stack.push_back({m, part.b, changesM, part.changesB});
+            stack.push_back({part.a, m, part.changesA, changesM});
+        }
+    }
+    return result;
+}
 
+std::vector<EquationSolver::Root> EquationSolver::findPolynomialRealRoots(math::Polynomial* polynomial, math::CompiledEquation* function, math::Interval* entredInterval, double resolution, const Method& method, int precision, int& iterations) {
+    math::Interval* brackets = isolatePolynomialRoots(polynomial, entredInterval, iterations);
+    // the coefficients only count roots, signs come from the equation itself. Where they disagree, a root moved onto
+    // an end or a touching root, the bracket is searched like any other interval
+    math::Interval trusted;
+    math::Interval untrusted;
+    std::vector<Root> roots;
+    // exact zeros on shared ends are reported once
+    double reported = std::numeric_limits<double>::quiet_NaN();
+    for (int i = 0; i < brackets->size(); i++) {
+        math::Tuple bracket = brackets->getAt(i);
+        double fa = function->calculate(bracket.a);
+        double fb = function->calculate(bracket.b);
+        iterations += 2;
+        if (fa == 0 && bracket.a != reported) {
+            roots.push_back(Root(math::Tuple(bracket.a, bracket.a), bracket.a, 0));
+            reported = bracket.a;
+        }
+        if (fb == 0 && bracket.b != reported) {
+            roots.push_back(Root(math::Tuple(bracket.b, bracket.b), bracket.b, 0));
+            reported = bracket.b;
+        }
+        if (bracket.a == bracket.b) {
+            continue;
+        }
+        if (isBracket(fa, fb)) {
+            // narrow like findRoots does, methods that start from one end need to start close to the root
+            trusted.addEntry(narrowBracket(function, bracket.a, bracket.b, fa, resolution, iterations));
+            continue;
+        }
+        // another root may still be inside, next to the one on an end
+        if (fa == 0) {
+            bracket.a = std::nextafter(bracket.a, bracket.b);
+        }
+        if (fb == 0) {
+            bracket.b = std::nextafter(bracket.b, bracket.a);
+        }
+        if (bracket.a < bracket.b) {
+            untrusted.addEntry(bracket);
+        }
+    }
+    delete brackets;
+
+    std::vector<Root> refined = refineRoots(&trusted, method);
+    roots.insert(roots.end(), refined.begin(), refined.end());
+    if (untrusted.size() > 0) {
+        int searchIterations = 0;
+        std::vector<Root> found = findRoots(function, &untrusted, resolution, method, precision, searchIterations);
+        iterations += searchIterations;
+        roots.insert(roots.end(), found.begin(), found.end());
+    }
+    sortRoots(roots);
+    return roots;
+}
+
+std::vector<std::complex<double>> EquationSolver::findComplexPolynomialRoots(math::Polynomial* polynomial, math::CompiledEquation* function, int precision, int& iterations) {
+    std::vector<std::complex<double>> complexRoots;
+    // coefficients expanded from a product lose digits, every root has to bring the equation itself below tolerance
+    double tolerance = std::pow(10, -precision);
+    for (const std::complex<double>& z : polynomial->roots(iterations)) {
+        double x = z.real();
+        // roots of multiplicity m only settle to about eps^(1/m), so real ones are told apart by the value of p
+        // rather than by the imaginary part alone
+        bool nearAxis = std::abs(z.imag()) <= POLYNOMIAL_REAL_TOLERANCE * std::max(1.0, std::abs(z));
+        if (nearAxis && std::abs(polynomial->calculate(x)) <= 16 * polynomial->roundingError(x)) {
+            continue;
+        }
+        // a multiple real root spreads into a ring of complex ones, but there the real part is a root already
+        if (z.imag() > 0 && std::abs(function->calculate(z)) < tolerance && std::abs(function->calculate(x)) >= tolerance) {
+            complexRoots.push_back(z);
+        }
+    }
+    return complexRoots;
+}
+
+bool EquationSolver::solveUsingNewtonMethod(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    (void)b;
     double xk = a;
     double xk1 = -1;
-    double fx;
+    double dfx;
+    double fx = equation->calculateWithDerivative(xk, dfx);
     int iterations = 0;
     while (true) {
         if (iterations > 100000) {
             return false;
         }
-        xk1 = auxFunc->evaluate(xk)->getValue();
-        fx = equation->evaluate(xk1)->getValue();
+        // f and f' of the new point come from one pass and serve both the check and the next step
+        xk1 = xk - fx / dfx;
+        fx = equation->calculateWithDerivative(xk1, dfx);
 
-	if (abs(fx) < pow(10, -precision)) {
+	if (std::abs(fx) < std::pow(10, -precision)) {
 	    root = xk1;
 	    iterationCount = iterations;
 	    return true;
@@ -112,7 +562,7 @@ bool EquationSolver::solveUsingDichotomy(math::Entry* equation, double a, double
     double left;
     double right;
 
-    if (equation->evaluate(b)->getValue() > 0) {
+    if (equation->calculate(b) > 0) {
         left = a;
         right = b;
     } else {
@@ -127,14 +577,14 @@ bool EquationSolver::solveUsingDichotomy(math::Entry* equation, double a, double
         }
 
 	x = (left + right) / 2;
-	f = equation->evaluate(x)->getValue();
+	f = equation->calculate(x);
 	if (f > 0) {
 	    right = x;
 	} else {
 	    left = x;
 	}
 
-	if (abs(f) < pow(10, -precision)) {
+	if (std::abs(f) < std::pow(10, -precision)) {
 	    root = x;
 	    iterationCount = iterations;
 	    return true;
@@ -144,3 +594,583 @@ bool EquationSolver::solveUsingDichotomy(math::Entry* equation, double a, double
 
     return false;
 }
+
+bool EquationSolver::solveUsingBrent(math::Entry* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    double fa = equation->calculate(a);
+    double fb = equation->calculate(b);
+    double tolerance = std::pow(10, -precision);
+    if (std::abs(fa) < tolerance || std::abs(fb) < tolerance) {
+        root = std::abs(fa) < std::abs(fb) ? a : b;
+        iterationCount = 0;
+        return true;
+    }
+    if (sign(fa) * sign(fb) != -1) {
+        return false;
+    }
+
+    // b is the best estimate, [b, c] always brackets the root, a is the previous b
+    double c = a;
+    double fc = fa;
+    double step = b - a;
+    double previousStep = step;
+    int iterations = 0;
+    while (true) {
+        if (iterations > 100000) {
+            return false;
+        }
+        if (sign(fb) == sign(fc)) {
+            c = a;
+            fc = fa;
+            step = b - a;
+            previousStep = step;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double xTolerance = 2 * std::numeric_limits<double>::epsilon() * std::abs(b) + tolerance / 2;
+        double middle = (c - b) / 2;
+        if (std::abs(middle) <= xTolerance || std::abs(fb) < tolerance) {
+            root = b;
+            iterationCount = iterations;
+            return true;
+        }
+
+        if (std::abs(previousStep) >= xTolerance && std::abs(fa) > std::abs(fb)) {
+            // secant when there are two distinct points, inverse quadratic interpolation with three
+            double s = fb / fa;
+            double p, q;
+            if (a == c) {
+                p = 2 * middle * s;
+                q = 1 - s;
+            } else {
+                double r = fb / fc;
+                q = fa / fc;
+                p = s * (2 * middle * q * (q - r) - (b - a) * (r - 1));
+                q = (q - 1) * (r - 1) * (s - 1);
+            }
+            if (p > 0) {
+                q = -q;
+            } else {
+                p = -p;
+            }
+            // interpolation must land inside the bracket and shrink faster than bisection would
+            if (2 * p < std::min(3 * middle * q - std::abs(xTolerance * q), std::abs(previousStep * q))) {
+                previousStep = step;
+                step = p / q;
+            } else {
+                step = middle;
+                previousStep = step;
+            }
+        } else {
+            step = middle;
+            previousStep = step;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(step) > xTolerance ? step : (middle > 0 ? xTolerance : -xTolerance);
+        fb = equation->calculate(b);
+        iterations++;
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingSafeNewton(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    double da, db;
+    double fa = equation->calculateWithDerivative(a, da);
+    double fb = equation->calculateWithDerivative(b, db);
+    double tolerance = std::pow(10, -precision);
+    if (std::abs(fa) < tolerance || std::abs(fb) < tolerance) {
+        root = std::abs(fa) < std::abs(fb) ? a : b;
+        iterationCount = 0;
+        return true;
+    }
+    if (sign(fa) * sign(fb) != -1) {
+        return false;
+    }
+
+    // f(negative) < 0 < f(positive), the bracket between them shrinks with every step
+    double negative = fa < 0 ? a : b;
+    double positive = fa < 0 ? b : a;
+    double x = a + (b - a) / 2;
+    double step = b - a;
+    double previousStep = step;
+    double dfx;
+    double fx = equation->calculateWithDerivative(x, dfx);
+    int iterations = 0;
+    while (true) {
+        if (iterations > 100000) {
+            return false;
+        }
+        if (std::abs(fx) < tolerance) {
+            root = x;
+            iterationCount = iterations;
+            return true;
+        }
+        if (fx < 0) {
+            negative = x;
+        } else {
+            positive = x;
+        }
+
+        double lo = std::min(negative, positive);
+        double hi = std::max(negative, positive);
+        double newton = x - fx / dfx;
+        // bisect when Newton leaves the bracket or does not at least halve the step before last
+        if (!(newton > lo && newton < hi) || std::abs(2 * fx) > std::abs(previousStep * dfx)) {
+            previousStep = step;
+            step = (hi - lo) / 2;
+            x = lo + step;
+        } else {
+            previousStep = step;
+            step = x - newton;
+            x = newton;
+        }
+        if (std::abs(step) < tolerance || hi - lo < tolerance) {
+            root = x;
+            iterationCount = iterations;
+            return true;
+        }
+        fx = equation->calculateWithDerivative(x, dfx);
+        iterations++;
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingITP(math::Entry* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    double fa = equation->calculate(a);
+    double fb = equation->calculate(b);
+    double tolerance = std::pow(10, -precision);
+    if (std::abs(fa) < tolerance || std::abs(fb) < tolerance) {
+        root = std::abs(fa) < std::abs(fb) ? a : b;
+        iterationCount = 0;
+        return true;
+    }
+    if (sign(fa) * sign(fb) != -1) {
+        return false;
+    }
+
+    // truncation size k1 * (b - a)^k2 with k2 = 2, and n0 steps of slack over bisection
+    double k1 = ITP_TRUNCATION / (b - a);
+    double epsilon = tolerance / 2;
+    int bisectionSteps = std::max(0, static_cast<int>(std::ceil(std::log2((b - a) / tolerance))));
+    int maxSteps = bisectionSteps + ITP_SLACK_STEPS;
+    int iterations = 0;
+    while (b - a > tolerance) {
+        if (iterations > 100000) {
+            return false;
+        }
+        double middle = a + (b - a) / 2;
+        // projection radius keeps the bracket within maxSteps halvings of the start
+        double radius = std::ldexp(epsilon, maxSteps - iterations) - (b - a) / 2;
+        double truncation = k1 * (b - a) * (b - a);
+
+        // interpolate with regula falsi, truncate towards the middle, project into the minmax ball
+        double falsi = (fb * a - fa * b) / (fb - fa);
+        int direction = sign(middle - falsi);
+        double x = truncation <= std::abs(middle - falsi) ? falsi + direction * truncation : middle;
+        if (std::abs(x - middle) > radius) {
+            x = middle - direction * radius;
+        }
+        if (!(x > a && x < b)) {
+            x = middle;
+            if (x <= a || x >= b) {
+                break;
+            }
+        }
+
+        double fx = equation->calculate(x);
+        iterations++;
+        if (std::abs(fx) < tolerance) {
+            root = x;
+            iterationCount = iterations;
+            return true;
+        }
+        if (sign(fx) == sign(fa)) {
+            a = x;
+            fa = fx;
+        } else {
+            b = x;
+            fb = fx;
+        }
+    }
+
+    root = a + (b - a) / 2;
+    iterationCount = iterations;
+    return true;
+}
+
+bool EquationSolver::solveUsingHouseholder(math::CompiledEquation* equation, int order, double a, double b, int precision, double& root, int& iterationCount) {
+    (void)b;
+    size_t n = std::max(1, std::min(order, HOUSEHOLDER_MAX_ORDER)) + 1;
+    double derivatives[HOUSEHOLDER_MAX_ORDER + 1];
+    // Taylor coefficients of f and of 1 / f at the current point
+    double series[HOUSEHOLDER_MAX_ORDER + 1];
+    double reciprocal[HOUSEHOLDER_MAX_ORDER + 1];
+    double one[HOUSEHOLDER_MAX_ORDER + 1] = {1};
+
+    double xk = a;
+    double xk1 = -1;
+    equation->calculateDerivatives(xk, n - 1, derivatives);
+    int iterations = 0;
+    while (true) {
+        if (iterations > 100000) {
+            return false;
+        }
+        // x + d (1/f)^(d-1) / (1/f)^(d), the factorials of the derivatives cancel down to a ratio of coefficients
+        double factorial = 1;
+        for (size_t i = 0; i < n; i++) {
+            if (i > 0) {
+                factorial *= i;
+            }
+            series[i] = derivatives[i] / factorial;
+        }
+        math::taylor::divide(one, series, reciprocal, n);
+        xk1 = xk + reciprocal[n - 2] / reciprocal[n - 1];
+        equation->calculateDerivatives(xk1, n - 1, derivatives);
+
+        if (std::abs(derivatives[0]) < std::pow(10, -precision)) {
+            root = xk1;
+            iterationCount = iterations;
+            return true;
+        }
+        xk = xk1;
+        iterations++;
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingMultipleRootNewton(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    (void)b;
+    double tolerance = std::pow(10, -precision);
+    double derivatives[3];
+    double next[3];
+
+    double xk = a;
+    equation->calculateDerivatives(xk, 2, derivatives);
+    int iterations = 0;
+    while (true) {
+        if (iterations > 100000) {
+            return false;
+        }
+        double fx = derivatives[0];
+        double dfx = derivatives[1];
+        if (fx == 0) {
+            root = xk;
+            iterationCount = iterations;
+            return true;
+        }
+        if (dfx == 0 || !std::isfinite(fx) || !std::isfinite(dfx)) {
+            return false;
+        }
+        // u = f / f' has a simple root wherever f has one of multiplicity m, and u' tends to 1 / m there
+        double denominator = dfx * dfx - fx * derivatives[2];
+        double estimate = denominator != 0 ? dfx * dfx / denominator : 1;
+        double multiplicity = std::isfinite(estimate) ? std::max(1.0, std::min(std::round(estimate), (double)MULTIPLE_ROOT_MAX_MULTIPLICITY)) : 1;
+
+        double step = multiplicity * fx / dfx;
+        double xk1 = xk - step;
+        equation->calculateDerivatives(xk1, 2, next);
+        // far from the root the estimate is noise, an overshoot falls back to a plain Newton step
+        if (multiplicity > 1 && !(std::abs(next[0]) < std::abs(fx))) {
+            step = fx / dfx;
+            xk1 = xk - step;
+            equation->calculateDerivatives(xk1, 2, next);
+        }
+        iterations++;
+
+        if (std::abs(step) < tolerance) {
+            root = xk1;
+            iterationCount = iterations;
+            return true;
+        }
+        xk = xk1;
+        std::copy(next, next + 3, derivatives);
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingMuller(math::CompiledEquation* equation, double a, double b, int precision, std::complex<double>& root, int& iterationCount) {
+    typedef std::complex<double> Complex;
+    double tolerance = std::pow(10, -precision);
+    if (!(b > a)) {
+        b = a + 1;
+    }
+    Complex x0 = a;
+    Complex x1 = b;
+    Complex x2 = a + (b - a) / 2;
+    Complex f0 = equation->calculate(x0);
+    Complex f1 = equation->calculate(x1);
+    Complex f2 = equation->calculate(x2);
+    int evaluations = 3;
+    while (evaluations <= 100000) {
+        if (f2 == 0.0) {
+            root = x2;
+            iterationCount = evaluations;
+            return true;
+        }
+        Complex h1 = x1 - x0;
+        Complex h2 = x2 - x1;
+        Complex d1 = (f1 - f0) / h1;
+        Complex d2 = (f2 - f1) / h2;
+        Complex curvature = (d2 - d1) / (h2 + h1);
+        Complex slope = curvature * h2 + d2;
+        Complex discriminant = std::sqrt(slope * slope - 4.0 * f2 * curvature);
+        // the larger denominator picks the zero of the parabola closest to x2
+        Complex denominator = std::abs(slope + discriminant) >= std::abs(slope - discriminant) ? slope + discriminant : slope - discriminant;
+        Complex step = denominator != 0.0 ? -2.0 * f2 / denominator : Complex(std::abs(h2) + tolerance, 0);
+        if (!std::isfinite(step.real()) || !std::isfinite(step.imag())) {
+            return false;
+        }
+
+        x0 = x1;
+        f0 = f1;
+        x1 = x2;
+        f1 = f2;
+        x2 = x2 + step;
+        f2 = equation->calculate(x2);
+        evaluations++;
+
+        if (std::abs(step) < tolerance) {
+            // steps also stall on a branch cut, where f jumps instead of vanishing
+            if (!(std::abs(f2) < tolerance)) {
+                return false;
+            }
+            root = x2;
+            iterationCount = evaluations;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingMuller(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    std::complex<double> z;
+    if (!solveUsingMuller(equation, a, b, precision, z, iterationCount)) {
+        return false;
+    }
+    // multiple roots are only found to a fraction of the digits, with some imaginary noise left
+    double tolerance = std::pow(10, -precision);
+    if (std::abs(z.imag()) >= tolerance && !(std::abs(equation->calculate(z.real())) < tolerance)) {
+        return false;
+    }
+    root = z.real();
+    return true;
+}
+
+bool EquationSolver::accelerateFixedPoint(const std::function<double(double)>& map, Acceleration acceleration, int depth, double x0, int precision, double& root, int& iterationCount) {
+    double tolerance = std::pow(10, -precision);
+    int evaluations = 0;
+    switch (acceleration) {
+        case Acceleration::None: {
+            double x = x0;
+            while (evaluations <= 100000 && std::isfinite(x)) {
+                double next = map(x);
+                evaluations++;
+                if (std::abs(next - x) < tolerance) {
+                    root = next;
+                    iterationCount = evaluations;
+                    return true;
+                }
+                x = next;
+            }
+            return false;
+        }
+        case Acceleration::Aitken: {
+            // extrapolates every three consecutive iterates, the iteration itself is left untouched
+            double x1 = map(x0);
+            double x2 = map(x1);
+            evaluations += 2;
+            double previous = x2;
+            while (evaluations <= 100000 && std::isfinite(x2)) {
+                double denominator = x2 - 2 * x1 + x0;
+                double extrapolated = denominator != 0 ? x2 - (x2 - x1) * (x2 - x1) / denominator : x2;
+                if (std::abs(extrapolated - previous) < tolerance || std::abs(x2 - x1) < tolerance) {
+                    root = extrapolated;
+                    iterationCount = evaluations;
+                    return true;
+                }
+                previous = extrapolated;
+                x0 = x1;
+                x1 = x2;
+                x2 = map(x2);
+                evaluations++;
+            }
+            return false;
+        }
+        case Acceleration::Steffensen: {
+            // restarts the iteration from every extrapolation, quadratic near a simple fixed point
+            double x = x0;
+            while (evaluations <= 100000 && std::isfinite(x)) {
+                double x1 = map(x);
+                double x2 = map(x1);
+                evaluations += 2;
+                double denominator = x2 - 2 * x1 + x;
+                double next = denominator != 0 ? x - (x1 - x) * (x1 - x) / denominator : x2;
+                if (std::abs(next - x) < tolerance) {
+                    root = next;
+                    iterationCount = evaluations;
+                    return true;
+                }
+                x = next;
+            }
+            return false;
+        }
+        case Acceleration::Anderson: {
+            // mixes the last `depth` steps so that their combined residual g(x) - x is smallest
+            size_t historySize = std::max(1, depth);
+            std::vector<double> residualSteps;
+            std::vector<double> mapSteps;
+            double x = x0;
+            double gx = map(x);
+            evaluations++;
+            double residual = gx - x;
+            while (evaluations <= 100000 && std::isfinite(gx)) {
+                if (std::abs(residual) < tolerance) {
+                    root = gx;
+                    iterationCount = evaluations;
+                    return true;
+                }
+                // one equation in residualSteps.size() unknowns, take the minimum norm least squares mix
+                double norm = 0;
+                for (double step : residualSteps) {
+                    norm += step * step;
+                }
+                double next = gx;
+                if (norm > 0) {
+                    for (size_t i = 0; i < residualSteps.size(); i++) {
+                        next -= residualSteps[i] * residual / norm * mapSteps[i];
+                    }
+                }
+
+                double gNext = map(next);
+                evaluations++;
+                double nextResidual = gNext - next;
+                residualSteps.push_back(nextResidual - residual);
+                mapSteps.push_back(gNext - gx);
+                if (residualSteps.size() > historySize) {
+                    residualSteps.erase(residualSteps.begin());
+                    mapSteps.erase(mapSteps.begin());
+                }
+                gx = gNext;
+                residual = nextResidual;
+            }
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool EquationSolver::solveUsingAcceleratedItterations(math::Entry* equation, math::Entry* cFunc, bool fast, Acceleration acceleration, int depth, double a, double b, int precision, double& root, int& iterationCount) {
+    (void)b;
+    std::function<double(double)> map;
+    if (fast) {
+        map = [equation, cFunc](double x) {
+            double cx = cFunc->calculate(x);
+            double fx = equation->calculate(x);
+            double difference = fx - equation->calculate(x - cx * fx);
+            // x is already a root, or as close as the difference can tell
+            if (difference == 0) {
+                return x;
+            }
+            return x - cx * fx * fx / difference;
+        };
+    } else {
+        map = [equation, cFunc](double x) {
+            return x + cFunc->calculate(x) * equation->calculate(x);
+        };
+    }
+    return accelerateFixedPoint(map, acceleration, depth, a, precision, root, iterationCount);
+}
+
+bool EquationSolver::solveUsingAutoItterations(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount) {
+    double tolerance = std::pow(10, -precision);
+    double fa = equation->calculate(a);
+    double fb = equation->calculate(b);
+    int evaluations = 2;
+
+    // c = -2 / (m + M) minimizes the contraction factor (M - m) / (M + m) of x + c f(x) when m <= f' <= M on [a, b].
+    // Enclosures that allow f' = 0 give no such bound, the chord slope is the next best guess.
+    math::Bounds derivative;
+    equation->calculateBoundsWithDerivative(math::Bounds(a, b), derivative);
+    double slope = (fb - fa) / (b - a);
+    if (std::isfinite(derivative.lo) && std::isfinite(derivative.hi) && !derivative.contains(0)) {
+        slope = (derivative.lo + derivative.hi) / 2;
+    }
+    if (!std::isfinite(slope) || slope == 0) {
+        return false;
+    }
+    int direction = sign(slope);
+
+    // with a sign change, steps are kept inside the shrinking bracket [lo, hi]
+    bool bracketed = isBracket(fa, fb);
+    double lo = a;
+    double hi = b;
+    double flo = fa;
+    double x = a;
+    double fx = fa;
+    if (std::abs(fb) < std::abs(fa)) {
+        x = b;
+        fx = fb;
+    }
+    double best = std::abs(fx);
+    int stalled = 0;
+    while (evaluations <= 100000) {
+        // relaxation is re-estimated from the chord of the last two iterates, which turns the iteration into secant steps
+        double next = x - fx / slope;
+        bool inside = next >= lo && next <= hi;
+        if (!inside) {
+            next = bracketed ? lo + (hi - lo) / 2 : std::max(lo, std::min(next, hi));
+        }
+        if (std::abs(next - x) < tolerance || (bracketed && hi - lo < tolerance)) {
+            // pinned to an end of a bracket without a root
+            if (!inside && !bracketed) {
+                return false;
+            }
+            root = next;
+            iterationCount = evaluations;
+            return true;
+        }
+        double fNext = equation->calculate(next);
+        evaluations++;
+        if (!std::isfinite(fNext)) {
+            return false;
+        }
+
+        double chord = (fNext - fx) / (next - x);
+        if (std::isfinite(chord) && sign(chord) == direction) {
+            slope = chord;
+        }
+        if (bracketed) {
+            if (sign(fNext) == sign(flo)) {
+                lo = next;
+                flo = fNext;
+            } else {
+                hi = next;
+            }
+        }
+        x = next;
+        fx = fNext;
+        if (std::abs(fx) < best) {
+            best = std::abs(fx);
+            stalled = 0;
+        } else if (++stalled > AUTO_ITERATION_PATIENCE) {
+            // diverging or cycling, more steps would only burn the budget
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -1,18 +1,118 @@
 #ifndef EQUATIONSOLVER_H
 #define EQUATIONSOLVER_H
 
+#include <complex>
+#include <functional>
+#include <vector>
+
 #include "equation.h"
 
+namespace math {
+class CompiledEquation;
+class Polynomial;
+}
+
 class EquationSolver {
 public:
+    // Refines a bracket into a root, false when the method did not converge
+    typedef std::function<bool(double a, double b, double& root, int& iterationCount)> Method;
+
+    // Extrapolation applied on top of a fixed point iteration x = g(x)
+    enum class Acceleration {
+        None,
+        // Aitken's delta squared on the plain iterates
+        Aitken,
+        // iteration restarted from every Aitken extrapolation
+        Steffensen,
+        // Anderson mixing of the last few steps
+        Anderson
+    };
+
+    struct Root {
+        math::Tuple bracket;
+        double x;
+        int iterations;
+
+        Root(math::Tuple bracket, double x, int iterations) : bracket(bracket), x(x), iterations(iterations) {
+        }
+    };
+
+    // Outcome of verifyRoots, every point of the searched intervals is in one of the lists. Regions of a list are
+    // sorted and disjoint, but may share end points with regions of the other lists
+    struct Verification {
+        // enclosures holding exactly one root each
+        std::vector<math::Tuple> roots;
+        // regions proven to hold no root
+        std::vector<math::Tuple> rootFree;
+        // boxes down to the resolution that could be neither proven nor excluded: multiple roots, poles, jumps
+        std::vector<math::Tuple> undecided;
+        // boxes processed
+        int boxes = 0;
+    };
+
     EquationSolver();
 
-    static math::Interval* splitInterval(math::Entry* function, math::Interval* entredInterval, double step, int& iterations);
+    // Branch and bound search on a work stealing pool, threadCount 0 means one thread per core. Boxes are bisected only
+    // while interval enclosures of f and f' allow a root inside, a box where f is monotonic holds at most one. Brackets
+    // are at most `resolution` wide and refined by the worker that found them: those with a sign change with method,
+    // touching roots of even multiplicity, where only f' changes sign, with solveUsingMultipleRootNewton to 10^-precision
+    // whatever the method. Roots are sorted by bracket, searchIterations counts evaluations of the search only.
+    // function and method must be safe to call from several threads.
+    static std::vector<Root> findRoots(math::CompiledEquation* function, math::Interval* entredInterval, double resolution, const Method& method, int precision, int& searchIterations, size_t threadCount = 0);
+    // Branch and bound with the Krawczyk operator over interval enclosures of f and of its symbolic derivative, or of the
+    // automatic one when derivative is nullptr. Unlike a search it proves which regions have one root and which have
+    // none, as long as f is continuously differentiable wherever the enclosures are finite (the symbolic derivative of
+    // sign() is zero, so its jumps need the automatic one). Boxes are verified in parallel, threadCount 0 means one
+    // thread per core.
+    static Verification verifyRoots(math::CompiledEquation* function, math::CompiledEquation* derivative, math::Interval* entredInterval, double resolution, size_t threadCount = 0);
+    // Refine every bracket in parallel, without searching
+    static std::vector<Root> refineRoots(math::Interval* brackets, const Method& method);
+    // Brackets holding exactly one distinct real root of the polynomial each, found by bisecting with Sturm sequence
+    // root counts. Roots closer than the step of a scan are still separated. Roots of even multiplicity get a bracket
+    // without a sign change. iterations counts evaluations of the Sturm sequence.
+    static math::Interval* isolatePolynomialRoots(math::Polynomial* polynomial, math::Interval* entredInterval, int& iterations);
+    // Real roots of function, the equation polynomial was expanded from. Sturm brackets with a sign change of function
+    // are refined with method, the others are searched with findRoots down to resolution, as rounding in the
+    // coefficients may move a root onto an end. iterations counts evaluations of the Sturm sequence and the search.
+    static std::vector<Root> findPolynomialRealRoots(math::Polynomial* polynomial, math::CompiledEquation* function, math::Interval* entredInterval, double resolution, const Method& method, int precision, int& iterations);
+    // Complex roots with a positive imaginary part, from all roots of the polynomial found at once with Aberth-Ehrlich.
+    // Only roots where |function|, the equation polynomial was expanded from, is below 10^-precision are kept.
+    // iterations counts Aberth-Ehrlich sweeps.
+    static std::vector<std::complex<double>> findComplexPolynomialRoots(math::Polynomial* polynomial, math::CompiledEquation* function, int precision, int& iterations);
     // All supported functions of solving for a root
-    static bool solveUsingSimpleItterations(math::Entry* equation, math::Entry* cFunc, double a, double b, int precision, double& root, int& iterationCount);
-    static bool solveUsingFastItterations(math::Entry* equation, math::Entry* cFunc, double a, double b, int precision, double& root, int& iterationCount);
-    static bool solveUsingNewtonMethod(math::Entry* equation, math::Entry* derivative, double a, double b, int precision, double& root, int& iterationCount);
+    // Fixed point iteration of map from x0, stops when two iterates are within 10^-precision.
+    // depth is the number of steps Anderson mixing remembers, iterationCount counts calls of map
+    static bool accelerateFixedPoint(const std::function<double(double)>& map, Acceleration acceleration, int depth, double x0, int precision, double& root, int& iterationCount);
+    // Simple or fast iteration under the given acceleration
+    static bool solveUsingAcceleratedItterations(math::Entry* equation, math::Entry* cFunc, bool fast, Acceleration acceleration, int depth, double a, double b, int precision, double& root, int& iterationCount);
+    // Simple iteration x = x + c f(x) with c picked from an enclosure of f' over [a, b] and then re-estimated
+    // from the last two iterates, so no c function is needed. iterationCount counts evaluations
+    static bool solveUsingAutoItterations(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // derivative comes from automatic differentiation of the compiled equation
+    static bool solveUsingNewtonMethod(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount);
     static bool solveUsingDichotomy(math::Entry* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // Brent's method: inverse quadratic interpolation and secant steps, falling back to bisection whenever they
+    // converge slowly or leave the bracket. Needs a sign change on [a, b]
+    static bool solveUsingBrent(math::Entry* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // Newton steps while they stay inside the shrinking bracket and converge fast, bisection otherwise.
+    // Needs a sign change on [a, b]
+    static bool solveUsingSafeNewton(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // Interpolate-truncate-project: regula falsi steps kept close enough to the middle that the bracket never takes more
+    // than one step beyond what dichotomy needs, superlinear on smooth functions. Needs a sign change on [a, b]
+    static bool solveUsingITP(math::Entry* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // Householder's method of the given order from a, converging with order + 1: 1 is Newton's, 2 is Halley's.
+    // Derivatives up to f^(order) come from one Taylor mode pass per step, order is clamped to 1..4
+    static bool solveUsingHouseholder(math::CompiledEquation* equation, int order, double a, double b, int precision, double& root, int& iterationCount);
+    // Newton's method with the step x - m f / f' scaled by the multiplicity m of the root, estimated every step as
+    // f'^2 / (f'^2 - f f'') from one Taylor mode pass. Converges quadratically at multiple roots, where plain Newton's
+    // is linear. Stops once steps get below 10^-precision, as |f| is tiny long before a multiple root is reached
+    static bool solveUsingMultipleRootNewton(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount);
+    // Muller's method: steps to the zero of the parabola through the last three points, starting from a, b and their
+    // middle. The parabola leaves the real line when it has no real zeros, so complex roots are found as well.
+    // iterationCount counts evaluations
+    static bool solveUsingMuller(math::CompiledEquation* equation, double a, double b, int precision, std::complex<double>& root, int& iterationCount);
+    // Real roots only, converging to a complex root fails right away instead of exhausting the iteration limit
+    static bool solveUsingMuller(math::CompiledEquation* equation, double a, double b, int precision, double& root, int& iterationCount);
 };
 
 #endif  // EQUATIONSOLVER_H
@@ -0,0 +1,62 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+#include <cmath>
+#include <complex>
+
+namespace math {
+
+// Scalar math of every operator, specialized for each number type equations can be evaluated in.
+// Arithmetic (+ - * /) comes from the type itself.
+template <typename T>
+struct Kernel;
+
+template <>
+struct Kernel<double> {
+    static double sin(double x) { return std::sin(x); }
+    static double cos(double x) { return std::cos(x); }
+    static double tan(double x) { return std::tan(x); }
+    static double cot(double x) { return 1 / std::tan(x); }
+    static double ln(double x) { return std::log(x); }
+    static double log(double base, double value) { return std::log(value) / std::log(base); }
+    static double pow(double base, double exponent) { return std::pow(base, exponent); }
+    static double sqrt(double x) { return std::sqrt(x); }
+    static double abs(double x) { return std::abs(x); }
+    static double sign(double x) { return (0 < x) - (x < 0); }
+};
+
+// Principal branches of every function, so equations without real roots still have complex ones to find.
+// abs is the modulus and sign is z / |z|
+template <>
+struct Kernel<std::complex<double>> {
+    typedef std::complex<double> Complex;
+
+    static Complex sin(const Complex& x) { return std::sin(x); }
+    static Complex cos(const Complex& x) { return std::cos(x); }
+    static Complex tan(const Complex& x) { return std::tan(x); }
+    static Complex cot(const Complex& x) { return 1.0 / std::tan(x); }
+    static Complex ln(const Complex& x) { return std::log(x); }
+    static Complex log(const Complex& base, const Complex& value) { return std::log(value) / std::log(base); }
+    static Complex pow(const Complex& base, const Complex& exponent) {
+        // integer powers by squaring, exp(e ln b) loses accuracy and is undefined for negative powers of zero
+        if (exponent.imag() == 0 && exponent.real() == std::round(exponent.real()) && std::abs(exponent.real()) <= 64) {
+            int n = (int)std::abs(exponent.real());
+            Complex result = 1;
+            Complex factor = base;
+            for (; n > 0; n >>= 1) {
+                if (n & 1) {
+                    result *= factor;
+                }
+                factor *= factor;
+            }
+            return exponent.real() < 0 ? 1.0 / result : result;
+        }
+        return std::pow(base, exponent);
+    }
+    static Complex sqrt(const Complex& x) { return std::sqrt(x); }
+    static Complex abs(const Complex& x) { return std::abs(x); }
+    static Complex sign(const Complex& x) { return x == 0.0 ? Complex(0) : x / std::abs(x); }
+};
+
+}  // namespace math
+
+#endif  // KERNEL_H
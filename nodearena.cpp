@@ -0,0 +1,128 @@
+#include "nodearena.h"
+#include "equation.h"
+
+#include <new>
+
+namespace math {
+
+// Size of regular chunks, bigger nodes get a chunk of their own
+#define NODE_ARENA_CHUNK_SIZE 65536
+
+// Placed in front of every node, for heap nodes too, so delete can tell them apart
+struct alignas(std::max_align_t) NodeArena::Header {
+    NodeArena* arena;
+    // cleared once the node was deleted explicitly, so reset does not destroy it twice
+    bool alive;
+};
+
+namespace {
+thread_local NodeArena* activeArena = nullptr;
+
+size_t alignSize(size_t size) {
+    const size_t alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+}
+}  // namespace
+
+NodeArena::Scope::Scope(NodeArena& arena) {
+    previous = activeArena;
+    activeArena = &arena;
+}
+
+NodeArena::Scope::~Scope() {
+    activeArena = previous;
+}
+
+NodeArena::NodeArena() {
+    position = nullptr;
+    end = nullptr;
+}
+
+NodeArena::~NodeArena() {
+    reset();
+}
+
+void NodeArena::reset() {
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i]->alive) {
+            nodes[i]->alive = false;
+            static_cast<Entry*>(static_cast<void*>(nodes[i] + 1))->~Entry();
+        }
+    }
+    nodes.clear();
+    uniqueNodes.clear();
+    internedNodes.clear();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        ::operator delete(chunks[i]);
+    }
+    chunks.clear();
+    position = nullptr;
+    end = nullptr;
+}
+
+Entry* NodeArena::intern(Entry* entry) {
+    auto interned = internedNodes.find(entry);
+    if (interned != internedNodes.end()) {
+        return interned->second;
+    }
+    Entry* canonical = entry->intern(*this);
+    internedNodes[entry] = canonical;
+    internedNodes[canonical] = canonical;
+    return canonical;
+}
+
+Entry* NodeArena::unique(const std::string& key, Entry* entry) {
+    return uniqueNodes.insert(std::make_pair(key, entry)).first->second;
+}
+
+NodeArena* NodeArena::current() {
+    return activeArena;
+}
+
+void* NodeArena::allocate(size_t size) {
+    if (activeArena != nullptr) {
+        return activeArena->allocateNode(size);
+    }
+    Header* header = static_cast<Header*>(::operator new(sizeof(Header) + size));
+    header->arena = nullptr;
+    header->alive = true;
+    return header + 1;
+}
+
+void NodeArena::release(void* pointer) {
+    Header* header = static_cast<Header*>(pointer) - 1;
+    if (header->arena == nullptr) {
+        ::operator delete(header);
+    } else {
+        header->alive = false;
+    }
+}
+
+bool NodeArena::isArenaNode(const void* pointer) {
+    return (static_cast<const Header*>(pointer) - 1)->arena != nullptr;
+}
+
+void* NodeArena::allocateNode(size_t size) {
+    size_t required = sizeof(Header) + alignSize(size);
+    char* memory;
+    if (required > NODE_ARENA_CHUNK_SIZE / 4) {
+        memory = static_cast<char*>(::operator new(required));
+        chunks.push_back(memory);
+    } else {
+        if (position == nullptr || (size_t)(end - position) < required) {
+            position = static_cast<char*>(::operator new(NODE_ARENA_CHUNK_SIZE));
+            end = position + NODE_ARENA_CHUNK_SIZE;
+            chunks.push_back(position);
+        }
+        memory = position;
+        position += required;
+    }
+
+    Header* header = reinterpret_cast<Header*>(memory);
+    header->arena = this;
+    header->alive = true;
+    nodes.push_back(header);
+    return header + 1;
+}
+
+}  // namespace math
@@ -0,0 +1,71 @@
+#ifndef NODEARENA_H
+#define NODEARENA_H
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace math {
+
+class Entry;
+
+// Bump allocator owning every equation node created while one of its scopes is active.
+// Nodes are destroyed all at once by reset() or when the arena is destroyed, deleting one
+// of them only runs its destructor. Outside of any scope nodes go to the regular heap.
+class NodeArena {
+public:
+    // Makes an arena current for the calling thread until the scope ends
+    class Scope {
+    private:
+        NodeArena* previous;
+
+    public:
+        Scope(NodeArena& arena);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    NodeArena();
+    ~NodeArena();
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    // Destroy all nodes and release memory
+    void reset();
+
+    // Hash-consing: rewrite the tree so structurally identical subtrees become one shared node
+    // and return its canonical root. Subtrees of trees interned earlier are shared as well.
+    // Resulting DAG must stay in the arena, deleting heap operators would free shared children twice.
+    Entry* intern(Entry* entry);
+    // Canonical node with the given structural key, `entry` becomes it if the key is new
+    Entry* unique(const std::string& key, Entry* entry);
+
+    // Arena nodes are allocated from, nullptr when there is no scope
+    static NodeArena* current();
+
+    // Storage for a node from the current arena or the heap, used by Entry::operator new/delete
+    static void* allocate(size_t size);
+    static void release(void* pointer);
+    // Was the node placed into an arena. Only valid for nodes created with new
+    static bool isArenaNode(const void* pointer);
+
+private:
+    struct Header;
+
+    void* allocateNode(size_t size);
+
+    std::vector<char*> chunks;
+    std::vector<Header*> nodes;
+    std::unordered_map<std::string, Entry*> uniqueNodes;
+    // canonical node for every node already interned
+    std::unordered_map<Entry*, Entry*> internedNodes;
+    char* position;
+    char* end;
+};
+
+}  // namespace math
+
+#endif  // NODEARENA_H
@@ -0,0 +1,397 @@
+#include "polynomial.h"
+#include "equation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace math {
+
+// Sweeps of the Aberth-Ehrlich iteration before giving up on roots that did not settle
+#define POLYNOMIAL_ABERTH_ITERATIONS 500
+// Remainder coefficients below this, relative to the magnitude of the terms they were summed from, are cancellation noise
+#define STURM_ZERO_TOLERANCE 1e-12
+
+namespace {
+void trim(std::vector<double>& coefficients) {
+    while (coefficients.size() > 1 && coefficients.back() == 0) {
+        coefficients.pop_back();
+    }
+}
+
+std::vector<double> multiply(const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> product(a.size() + b.size() - 1, 0);
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            product[i + j] += a[i] * b[j];
+        }
+    }
+    trim(product);
+    return product;
+}
+
+bool isNonNegativeInteger(double value) {
+    return value >= 0 && std::floor(value) == value;
+}
+
+// Coefficients of entry, false if it is not a polynomial of at most maxDegree
+bool extract(Entry* entry, size_t maxDegree, std::vector<double>& result) {
+    if (!entry->isVariable()) {
+        result.assign(1, entry->calculate(0));
+        return std::isfinite(result[0]);
+    }
+    if (dynamic_cast<VariableEntry*>(entry) != nullptr) {
+        result.assign({0, 1});
+        return maxDegree >= 1;
+    }
+    // unparsed string entries hand out their parsed tree from evaluate
+    if (dynamic_cast<StringEntry*>(entry) != nullptr) {
+        return extract(entry->evaluate(0), maxDegree, result);
+    }
+
+    Operator* op = dynamic_cast<Operator*>(entry);
+    if (op == nullptr) {
+        return false;
+    }
+    const std::vector<Entry*>& inputs = op->getInputs();
+    if (inputs.size() < op->acceptedArgsNumber()) {
+        return false;
+    }
+    std::string type = op->getType();
+    std::vector<double> operand;
+    if (type == "add" || type == "sub") {
+        if (type == "sub" && inputs.size() > 2) {
+            return false;
+        }
+        result.assign(1, 0);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (!extract(inputs[i], maxDegree, operand)) {
+                return false;
+            }
+            // sub is either a - b or -a
+            double factor = type == "sub" && (i == 1 || inputs.size() == 1) ? -1 : 1;
+            if (operand.size() > result.size()) {
+                result.resize(operand.size(), 0);
+            }
+            for (size_t j = 0; j < operand.size(); j++) {
+                result[j] += factor * operand[j];
+            }
+        }
+        trim(result);
+        return true;
+    }
+    if (type == "mul") {
+        result.assign(1, 1);
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (!extract(inputs[i], maxDegree, operand) || result.size() + operand.size() - 2 > maxDegree) {
+                return false;
+            }
+            result = multiply(result, operand);
+        }
+        return true;
+    }
+    if (type == "div") {
+        if (inputs.size() != 2 || inputs[1]->isVariable()) {
+            return false;
+        }
+        double divisor = inputs[1]->calculate(0);
+        if (divisor == 0 || !std::isfinite(divisor) || !extract(inputs[0], maxDegree, result)) {
+            return false;
+        }
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] /= divisor;
+        }
+        return true;
+    }
+    if (type == "pow") {
+        if (inputs.size() != 2 || inputs[1]->isVariable()) {
+            return false;
+        }
+        double exponent = inputs[1]->calculate(0);
+        if (!isNonNegativeInteger(exponent) || exponent > maxDegree || !extract(inputs[0], maxDegree, operand)) {
+            return false;
+        }
+        size_t power = static_cast<size_t>(exponent);
+        if ((operand.size() - 1) * power > maxDegree) {
+            return false;
+        }
+        result.assign(1, 1);
+        for (size_t i = 0; i < power; i++) {
+            result = multiply(result, operand);
+        }
+        return true;
+    }
+    return false;
+}
+
+// p(z), p'(z) and the rounding error bound of p(z) with Horner's scheme on real and imaginary parts,
+// std::complex products check for infinities and NaN on every multiplication
+void horner(const std::vector<double>& a, std::complex<double> z, bool reversed, std::complex<double>& value, std::complex<double>& derivative, double& error) {
+    size_t n = a.size() - 1;
+    double zr = z.real();
+    double zi = z.imag();
+    double r = std::sqrt(zr * zr + zi * zi);
+    double pr = reversed ? a[0] : a[n];
+    double pi = 0;
+    double dr = 0;
+    double di = 0;
+    double bound = std::abs(pr);
+    for (size_t k = 1; k <= n; k++) {
+        double c = reversed ? a[k] : a[n - k];
+        double t = dr * zr - di * zi + pr;
+        di = dr * zi + di * zr + pi;
+        dr = t;
+        t = pr * zr - pi * zi + c;
+        pi = pr * zi + pi * zr;
+        pr = t;
+        bound = bound * r + std::abs(c);
+    }
+    value = std::complex<double>(pr, pi);
+    derivative = std::complex<double>(dr, di);
+    error = 4 * std::numeric_limits<double>::epsilon() * bound;
+}
+
+// p(z) / p'(z), zero when p(z) is within rounding error of zero and no step could tell z from the root any better.
+// For |z| > 1 computed from the reversed polynomial so that large roots do not overflow.
+std::complex<double> newtonRatio(const std::vector<double>& a, std::complex<double> z) {
+    std::complex<double> p, dp;
+    double error;
+    if (std::norm(z) <= 1) {
+        horner(a, z, false, p, dp, error);
+        if (std::abs(p) <= error) {
+            return 0;
+        }
+        return p / dp;
+    }
+    // p(z) = z^n q(1/z), so p / p' = z / (n - y q'(y) / q(y)) with y = 1/z
+    std::complex<double> y = 1.0 / z;
+    horner(a, y, true, p, dp, error);
+    if (std::abs(p) <= error) {
+        return 0;
+    }
+    return z / (static_cast<double>(a.size() - 1) - y * dp / p);
+}
+// Scale so the largest coefficient is 1, values of the chain only matter by sign
+void normalize(std::vector<double>& coefficients) {
+    double largest = 0;
+    for (double c : coefficients) {
+        largest = std::max(largest, std::abs(c));
+    }
+    if (largest > 0) {
+        for (double& c : coefficients) {
+            c /= largest;
+        }
+    }
+}
+
+// -(a mod b), empty when the remainder vanishes up to cancellation
+std::vector<double> negatedRemainder(std::vector<double> a, const std::vector<double>& b) {
+    size_t m = b.size() - 1;
+    // magnitude of everything summed into each coefficient, what rounding errors are relative to
+    std::vector<double> magnitude(a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        magnitude[i] = std::abs(a[i]);
+    }
+    for (size_t i = a.size(); i-- > m;) {
+        double factor = a[i] / b[m];
+        for (size_t j = 0; j <= m; j++) {
+            a[i - m + j] -= factor * b[j];
+            magnitude[i - m + j] += std::abs(factor * b[j]);
+        }
+        a[i] = 0;
+    }
+    a.resize(m > 0 ? m : 1);
+    bool vanishes = true;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i]) > STURM_ZERO_TOLERANCE * magnitude[i]) {
+            vanishes = false;
+        }
+        a[i] = -a[i];
+    }
+    if (vanishes) {
+        a.clear();
+        return a;
+    }
+    // a leading coefficient lost to cancellation lowers the degree
+    while (a.size() > 1 && std::abs(a.back()) <= STURM_ZERO_TOLERANCE * magnitude[a.size() - 1]) {
+        a.pop_back();
+    }
+    return a;
+}
+
+double horner(const std::vector<double>& a, double x) {
+    double p = a.back();
+    for (size_t i = a.size() - 1; i-- > 0;) {
+        p = p * x + a[i];
+    }
+    return p;
+}
+}  // namespace
+
+Polynomial::Polynomial(const std::vector<double>& coefficients) {
+    this->coefficients = coefficients;
+    if (this->coefficients.empty()) {
+        this->coefficients.push_back(0);
+    }
+    trim(this->coefficients);
+}
+
+Polynomial* Polynomial::fromEntry(Entry* entry, size_t maxDegree) {
+    std::vector<double> coefficients;
+    if (!extract(entry, maxDegree, coefficients)) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < coefficients.size(); i++) {
+        if (!std::isfinite(coefficients[i])) {
+            return nullptr;
+        }
+    }
+    return new Polynomial(coefficients);
+}
+
+size_t Polynomial::degree() {
+    return coefficients.size() - 1;
+}
+
+const std::vector<double>& Polynomial::getCoefficients() {
+    return coefficients;
+}
+
+double Polynomial::calculate(double x) {
+    size_t n = coefficients.size() - 1;
+    double p = coefficients[n];
+    for (size_t i = n; i-- > 0;) {
+        p = p * x + coefficients[i];
+    }
+    return p;
+}
+
+double Polynomial::roundingError(double x) {
+    size_t n = coefficients.size() - 1;
+    double r = std::abs(x);
+    double bound = std::abs(coefficients[n]);
+    for (size_t i = n; i-- > 0;) {
+        bound = bound * r + std::abs(coefficients[i]);
+    }
+    return 4 * std::numeric_limits<double>::epsilon() * bound;
+}
+
+std::vector<std::complex<double>> Polynomial::roots(int& iterations) {
+    iterations = 0;
+    std::vector<std::complex<double>> result;
+    // factor out x^k first, those roots are exact
+    size_t zeros = 0;
+    while (zeros < degree() && coefficients[zeros] == 0) {
+        zeros++;
+    }
+    result.assign(zeros, 0);
+    std::vector<double> a(coefficients.begin() + zeros, coefficients.end());
+    size_t n = a.size() - 1;
+    if (n == 0) {
+        return result;
+    }
+    if (n == 1) {
+        result.push_back(-a[0] / a[1]);
+        return result;
+    }
+
+    // start on a circle of the geometric mean root radius, turned off the real axis so conjugate pairs can split
+    double radius = std::pow(std::abs(a[0] / a[n]), 1.0 / n);
+    std::vector<std::complex<double>> z(n);
+    std::vector<bool> converged(n, false);
+    for (size_t j = 0; j < n; j++) {
+        z[j] = std::polar(radius, 2 * M_PI * j / n + 0.4);
+    }
+
+    size_t remaining = n;
+    while (remaining > 0 && iterations < POLYNOMIAL_ABERTH_ITERATIONS) {
+        iterations++;
+        for (size_t j = 0; j < n; j++) {
+            if (converged[j]) {
+                continue;
+            }
+            std::complex<double> ratio = newtonRatio(a, z[j]);
+            if (ratio == 0.0) {
+                converged[j] = true;
+                remaining--;
+                continue;
+            }
+            // sum of 1 / (z[j] - z[k]) as conj(d) / |d|^2, complex division is several times slower
+            double repulsionRe = 0;
+            double repulsionIm = 0;
+            for (size_t k = 0; k < n; k++) {
+                if (k != j) {
+                    double re = z[j].real() - z[k].real();
+                    double im = z[j].imag() - z[k].imag();
+                    double inverse = 1 / (re * re + im * im);
+                    repulsionRe += re * inverse;
+                    repulsionIm -= im * inverse;
+                }
+            }
+            std::complex<double> repulsion(repulsionRe, repulsionIm);
+            // Newton step corrected by the repulsion of the other approximations, updated in place
+            std::complex<double> step = ratio / (1.0 - ratio * repulsion);
+            if (!std::isfinite(step.real()) || !std::isfinite(step.imag())) {
+                // p' vanished or two approximations met, nudge the point and retry next sweep
+                z[j] += std::polar(radius * 1e-3 + 1e-12, 2 * M_PI * j / n);
+                continue;
+            }
+            z[j] -= step;
+            if (std::abs(step) <= 4 * std::numeric_limits<double>::epsilon() * std::abs(z[j])) {
+                converged[j] = true;
+                remaining--;
+            }
+        }
+    }
+
+    result.insert(result.end(), z.begin(), z.end());
+    return result;
+}
+
+SturmSequence::SturmSequence(Polynomial& polynomial) {
+    chain.push_back(polynomial.getCoefficients());
+    normalize(chain.back());
+    if (polynomial.degree() == 0) {
+        return;
+    }
+    const std::vector<double>& coefficients = polynomial.getCoefficients();
+    std::vector<double> derivative;
+    for (size_t i = 1; i < coefficients.size(); i++) {
+        derivative.push_back(coefficients[i] * i);
+    }
+    normalize(derivative);
+    chain.push_back(derivative);
+    while (chain.back().size() > 1) {
+        std::vector<double> remainder = negatedRemainder(chain[chain.size() - 2], chain.back());
+        if (remainder.empty()) {
+            break;
+        }
+        normalize(remainder);
+        chain.push_back(remainder);
+    }
+}
+
+size_t SturmSequence::size() {
+    return chain.size();
+}
+
+int SturmSequence::signChanges(double x) {
+    int changes = 0;
+    int previous = 0;
+    for (const std::vector<double>& p : chain) {
+        int s = sign(horner(p, x));
+        if (s != 0) {
+            if (previous != 0 && s != previous) {
+                changes++;
+            }
+            previous = s;
+        }
+    }
+    return changes;
+}
+
+int SturmSequence::countRoots(double a, double b) {
+    return signChanges(a) - signChanges(b);
+}
+
+}  // namespace math
@@ -0,0 +1,61 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+#include <complex>
+#include <vector>
+
+namespace math {
+
+class Entry;
+
+// Highest degree recognized by Polynomial::fromEntry
+#define POLYNOMIAL_MAX_DEGREE 100
+
+// Dense polynomial c[0] + c[1] x + ... + c[n] x^n evaluated with Horner's scheme.
+// Expanding a product loses digits, so it only counts roots and seeds root finding for the equation tree it was
+// recognized from, which is still the one evaluated.
+class Polynomial {
+protected:
+    // ascending powers, the last one is never zero
+    std::vector<double> coefficients;
+
+public:
+    Polynomial(const std::vector<double>& coefficients);
+
+    // Polynomial equal to entry when it only uses numbers, x, +, -, *, division by a constant and powers with
+    // a non-negative integer constant exponent, nullptr otherwise or when the degree is over maxDegree
+    static Polynomial* fromEntry(Entry* entry, size_t maxDegree = POLYNOMIAL_MAX_DEGREE);
+
+    size_t degree();
+    const std::vector<double>& getCoefficients();
+
+    double calculate(double x);
+    // Bound on the rounding error of calculate(x), |p(x)| below it can't be told from zero
+    double roundingError(double x);
+
+    // All degree() roots, complex ones included, found together with the Aberth-Ehrlich iteration.
+    // Roots at zero are exact, the others are accurate to rounding for simple roots.
+    // iterations counts sweeps over all roots
+    std::vector<std::complex<double>> roots(int& iterations);
+};
+
+// Sturm chain p, p', -rem(p, p'), ... of a polynomial. The number of sign changes of the chain drops by one at every
+// distinct real root, so it counts roots in an interval without finding them. Remainders are normalized and
+// coefficients lost to cancellation are dropped, so counts are exact only while roots are well separated
+// relative to rounding.
+class SturmSequence {
+protected:
+    std::vector<std::vector<double>> chain;
+
+public:
+    SturmSequence(Polynomial& polynomial);
+
+    size_t size();
+    // sign changes of the chain at x, zeros skipped
+    int signChanges(double x);
+    // distinct real roots in (a, b]
+    int countRoots(double a, double b);
+};
+
+}  // namespace math
+
+#endif  // POLYNOMIAL_H
@@ -0,0 +1,161 @@
+#include "taylor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace math {
+namespace taylor {
+
+// Recurrences follow from differentiating y = f(u): y' = f'(u) u' and matching coefficients,
+// see Griewank, Walther "Evaluating Derivatives", chapter 13.
+
+void multiply(const double* a, const double* b, double* output, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        double sum = 0;
+        for (size_t i = 0; i <= k; i++) {
+            sum += a[i] * b[k - i];
+        }
+        output[k] = sum;
+    }
+}
+
+void divide(const double* a, const double* b, double* output, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        double sum = a[k];
+        for (size_t i = 1; i <= k; i++) {
+            sum -= b[i] * output[k - i];
+        }
+        output[k] = sum / b[0];
+    }
+}
+
+void exp(const double* input, double* output, size_t n) {
+    output[0] = std::exp(input[0]);
+    for (size_t k = 1; k < n; k++) {
+        double sum = 0;
+        for (size_t i = 1; i <= k; i++) {
+            sum += i * input[i] * output[k - i];
+        }
+        output[k] = sum / k;
+    }
+}
+
+void ln(const double* input, double* output, size_t n) {
+    output[0] = std::log(input[0]);
+    for (size_t k = 1; k < n; k++) {
+        double sum = 0;
+        for (size_t i = 1; i < k; i++) {
+            sum += i * output[i] * input[k - i];
+        }
+        output[k] = (input[k] - sum / k) / input[0];
+    }
+}
+
+void sqrt(const double* input, double* output, size_t n) {
+    output[0] = std::sqrt(input[0]);
+    for (size_t k = 1; k < n; k++) {
+        double sum = input[k];
+        for (size_t i = 1; i < k; i++) {
+            sum -= output[i] * output[k - i];
+        }
+        output[k] = sum / (2 * output[0]);
+    }
+}
+
+void sinCos(const double* input, double* sin, double* cos, size_t n) {
+    sin[0] = std::sin(input[0]);
+    cos[0] = std::cos(input[0]);
+    for (size_t k = 1; k < n; k++) {
+        double sinSum = 0;
+        double cosSum = 0;
+        for (size_t i = 1; i <= k; i++) {
+            sinSum += i * input[i] * cos[k - i];
+            cosSum += i * input[i] * sin[k - i];
+        }
+        sin[k] = sinSum / k;
+        cos[k] = -cosSum / k;
+    }
+}
+
+namespace {
+// y' = sign * (1 + y^2) u', shared by tan (sign 1) and cot (sign -1); scratch keeps 1 + y^2
+void tangent(const double* input, double* output, double* square, double value, double sign, size_t n) {
+    output[0] = value;
+    square[0] = 1 + value * value;
+    for (size_t k = 1; k < n; k++) {
+        double sum = 0;
+        for (size_t i = 1; i <= k; i++) {
+            sum += i * input[i] * square[k - i];
+        }
+        output[k] = sign * sum / k;
+
+        double squareSum = 0;
+        for (size_t j = 0; j <= k; j++) {
+            squareSum += output[j] * output[k - j];
+        }
+        square[k] = squareSum;
+    }
+}
+
+// Binary exponentiation by series multiplication, for integer powers of a series starting at zero
+void integerPower(const double* base, unsigned long long power, double* output, size_t n) {
+    std::vector<double> factor(base, base + n);
+    std::vector<double> product(n);
+    output[0] = 1;
+    for (size_t k = 1; k < n; k++) {
+        output[k] = 0;
+    }
+    while (power > 0) {
+        if (power & 1) {
+            multiply(output, factor.data(), product.data(), n);
+            std::copy(product.begin(), product.end(), output);
+        }
+        power >>= 1;
+        if (power > 0) {
+            multiply(factor.data(), factor.data(), product.data(), n);
+            factor.swap(product);
+        }
+    }
+}
+}  // namespace
+
+void tan(const double* input, double* output, double* scratch, size_t n) {
+    tangent(input, output, scratch, std::tan(input[0]), 1, n);
+}
+
+void cot(const double* input, double* output, double* scratch, size_t n) {
+    tangent(input, output, scratch, 1 / std::tan(input[0]), -1, n);
+}
+
+void pow(const double* base, const double* exponent, double* output, double* scratch, size_t n) {
+    bool constantExponent = true;
+    for (size_t k = 1; k < n; k++) {
+        constantExponent = constantExponent && exponent[k] == 0;
+    }
+
+    double p = exponent[0];
+    if (constantExponent && base[0] != 0) {
+        // u y' = p u' y
+        output[0] = std::pow(base[0], p);
+        for (size_t k = 1; k < n; k++) {
+            double sum = 0;
+            for (size_t i = 1; i <= k; i++) {
+                sum += (p * i - (k - i)) * base[i] * output[k - i];
+            }
+            output[k] = sum / (k * base[0]);
+        }
+        return;
+    }
+    if (constantExponent && p >= 0 && p == std::floor(p) && p < 1e18) {
+        integerPower(base, (unsigned long long)p, output, n);
+        return;
+    }
+    // base ^ exponent = exp(exponent * ln(base))
+    ln(base, scratch, n);
+    multiply(exponent, scratch, scratch + n, n);
+    exp(scratch + n, output, n);
+}
+
+}  // namespace taylor
+}  // namespace math
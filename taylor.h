@@ -0,0 +1,27 @@
+#ifndef TAYLOR_H
+#define TAYLOR_H
+#include <cstddef>
+
+namespace math {
+
+// Arithmetic on truncated Taylor series, used to get higher derivatives of compiled equations.
+// A series is an array of n coefficients c[i] = f^(i)(x) / i!. Every function is O(n^2).
+// Outputs must not alias inputs.
+namespace taylor {
+
+void multiply(const double* a, const double* b, double* output, size_t n);
+void divide(const double* a, const double* b, double* output, size_t n);
+void exp(const double* input, double* output, size_t n);
+void ln(const double* input, double* output, size_t n);
+void sqrt(const double* input, double* output, size_t n);
+void sinCos(const double* input, double* sin, double* cos, size_t n);
+// scratch holds n values
+void tan(const double* input, double* output, double* scratch, size_t n);
+void cot(const double* input, double* output, double* scratch, size_t n);
+// output = base ^ exponent, scratch holds 2n values
+void pow(const double* base, const double* exponent, double* output, double* scratch, size_t n);
+
+}  // namespace taylor
+}  // namespace math
+
+#endif  // TAYLOR_H
@@ -0,0 +1,540 @@
+#include "vectormath.h"
+
+#if defined(__GNUC__) && !defined(__clang__)
+// Domain errors are handled by the kernels themselves and floating point exceptions are never
+// inspected. Without this GCC refuses to vectorize the select operations, even at -O3.
+#pragma GCC optimize("tree-vectorize", "vect-cost-model=dynamic", "no-trapping-math")
+#endif
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define VECTORMATH_DISPATCH __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define VECTORMATH_DISPATCH
+#endif
+
+// Kernels must be inlined into the loops for them to vectorize, GCC gives up on the bigger ones at -O2
+#if defined(__GNUC__)
+#define VECTORMATH_INLINE inline __attribute__((always_inline))
+#else
+#define VECTORMATH_INLINE inline
+#endif
+
+// Arrays are processed in chunks, so lanes that need the slow path can be flagged on the stack
+#define VECTORMATH_CHUNK 256
+
+namespace math {
+namespace vectormath {
+
+namespace {
+// 1.5 * 2^52, adding it rounds a double to an integer kept in the low mantissa bits
+const double ROUND_MAGIC = 6755399441055744.0;
+
+const double TWO_OVER_PI = 6.36619772367581382433e-01;
+// pi/2 split in three parts, first two have 33 significant bits so k * part is exact
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624879595063154e-21;
+// largest argument reduced with the constants above without losing accuracy
+const double TRIG_LIMIT = 1e5;
+
+const double LN2_HI = 6.93147180369123816490e-01;
+const double LN2_LO = 1.90821492927058770002e-10;
+const double INV_LN2 = 1.44269504088896338700e+00;
+// exp of larger arguments overflows or gives subnormal results
+const double EXP_LIMIT = 708;
+// bits of sqrt(2)/2, logarithm arguments are reduced to [sqrt(2)/2, sqrt(2))
+const uint64_t SQRT_HALF_BITS = 0x3fe6a09e667f3bcdULL;
+// integer powers below this are computed by repeated squaring
+const double POW_INTEGER_LIMIT = 8;
+
+inline uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Converts small non negative integer held in bits to double without int64 conversion
+// instructions, which baseline SSE2 lacks
+inline double smallToDouble(uint64_t value) {
+    return fromBits(0x4330000000000000ULL | value) - 4503599627370496.0;
+}
+
+// sin and cos of r in [-pi/4, pi/4], fdlibm kernels
+inline double sinKernel(double r) {
+    const double S1 = -1.66666666666666324348e-01;
+    const double S2 = 8.33333333332248946124e-03;
+    const double S3 = -1.98412698298579493134e-04;
+    const double S4 = 2.75573137070700676789e-06;
+    const double S5 = -2.50507602534068634195e-08;
+    const double S6 = 1.58969099521155010221e-10;
+    double z = r * r;
+    double v = z * r;
+    double p = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+    return r + v * (S1 + z * p);
+}
+
+inline double cosKernel(double r) {
+    const double C1 = 4.16666666666666019037e-02;
+    const double C2 = -1.38888888888741095749e-03;
+    const double C3 = 2.48015872894767294178e-05;
+    const double C4 = -2.75573143513906633035e-07;
+    const double C5 = 2.08757232129817482790e-09;
+    const double C6 = -1.13596475577881948265e-11;
+    double z = r * r;
+    double p = z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    double hz = 0.5 * z;
+    double w = 1 - hz;
+    return w + (((1 - w) - hz) + z * p);
+}
+
+// Reduce x to r in [-pi/4, pi/4], x = r + k * pi/2. Returns k mod 4
+inline uint64_t reduce(double x, double& r) {
+    double shifted = x * TWO_OVER_PI + ROUND_MAGIC;
+    double k = shifted - ROUND_MAGIC;
+    r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+    return toBits(shifted) & 3;
+}
+
+inline double negateIf(double value, uint64_t condition) {
+    return fromBits(toBits(value) ^ (condition << 63));
+}
+
+// Bitwise select of first if lowest bit of condition is set, baseline SSE2 has no 64 bit compares
+inline double selectIf(uint64_t condition, double first, double second) {
+    uint64_t mask = 0 - (condition & 1);
+    return fromBits((toBits(first) & mask) | (toBits(second) & ~mask));
+}
+
+// exp of |x| <= EXP_LIMIT, fdlibm kernel
+inline double expKernel(double x) {
+    const double P1 = 1.66666666666666019037e-01;
+    const double P2 = -2.77777777770155933842e-03;
+    const double P3 = 6.61375632143793436117e-05;
+    const double P4 = -1.65339022054652515390e-06;
+    const double P5 = 4.13813679705723846039e-08;
+    double shifted = x * INV_LN2 + ROUND_MAGIC;
+    double k = shifted - ROUND_MAGIC;
+    double hi = x - k * LN2_HI;
+    double lo = k * LN2_LO;
+    double r = hi - lo;
+    double t = r * r;
+    double c = r - t * (P1 + t * (P2 + t * (P3 + t * (P4 + t * P5))));
+    double y = 1 - ((lo - (r * c) / (2 - c)) - hi);
+    // add k to the exponent, k is kept as two's complement in the low bits of shifted
+    return fromBits(toBits(y) + ((toBits(shifted) - toBits(ROUND_MAGIC)) << 52));
+}
+
+// natural logarithm of normal positive x, fdlibm kernel
+inline double lnKernel(double x) {
+    const double Lg1 = 6.666666666666735130e-01;
+    const double Lg2 = 3.999999999940941908e-01;
+    const double Lg3 = 2.857142874366239149e-01;
+    const double Lg4 = 2.222219843214978396e-01;
+    const double Lg5 = 1.818357216161805012e-01;
+    const double Lg6 = 1.531383769920937332e-01;
+    const double Lg7 = 1.479819860511658591e-01;
+    // x = 2^k * z with z in [sqrt(2)/2, sqrt(2)), biased by 1024 to stay unsigned
+    uint64_t ix = toBits(x);
+    uint64_t biasedK = (ix - SQRT_HALF_BITS + (1024ULL << 52)) >> 52;
+    double z = fromBits(ix - ((biasedK - 1024) << 52));
+    double k = smallToDouble(biasedK) - 1024;
+
+    double f = z - 1;
+    double s = f / (2 + f);
+    double s2 = s * s;
+    double s4 = s2 * s2;
+    double t1 = s4 * (Lg2 + s4 * (Lg4 + s4 * Lg6));
+    double t2 = s2 * (Lg1 + s4 * (Lg3 + s4 * (Lg5 + s4 * Lg7)));
+    double r = t1 + t2;
+    double hfsq = 0.5 * f * f;
+    return k * LN2_HI - ((hfsq - (s * (hfsq + r) + k * LN2_LO)) - f);
+}
+
+// Product a * b = high + low (Dekker), only the smallest partial product of low is rounded. Factors are split by
+// clearing their low 27 bits rather than with Veltkamp's multiply, which the compiler may fuse into an FMA and break
+inline double exactProduct(double a, double b, double& low) {
+    const uint64_t SPLIT_MASK = 0xfffffffff8000000ULL;
+    double high = a * b;
+    double ah = fromBits(toBits(a) & SPLIT_MASK);
+    double al = a - ah;
+    double bh = fromBits(toBits(b) & SPLIT_MASK);
+    double bl = b - bh;
+    low = ((ah * bh - high) + ah * bl + al * bh) + al * bl;
+    return high;
+}
+
+// Sum a + b = high + low without rounding error (Knuth)
+inline double exactSum(double a, double b, double& low) {
+    double high = a + b;
+    double bv = high - a;
+    low = (a - (high - bv)) + (b - bv);
+    return high;
+}
+
+// Natural logarithm of normal positive x split into high + low parts carrying about 10 more bits,
+// pow needs them because exp turns an absolute error of y * ln(x) into a relative one. The minimax
+// polynomial of lnKernel is only accurate to 2^-58, so this sums ln(z) = 2 atanh(s) with
+// s = (z - 1) / (z + 1) from its series instead, |s| < 0.172 makes 12 terms enough
+VECTORMATH_INLINE double lnKernelExtended(double x, double& low) {
+    uint64_t ix = toBits(x);
+    uint64_t biasedK = (ix - SQRT_HALF_BITS + (1024ULL << 52)) >> 52;
+    double z = fromBits(ix - ((biasedK - 1024) << 52));
+    double k = smallToDouble(biasedK) - 1024;
+
+    double f = z - 1;
+    // s = f / (2 + f) with the rounding error of the division and of 2 + f kept in sLow
+    double denominatorLow;
+    double denominator = exactSum(2, f, denominatorLow);
+    double s = f / denominator;
+    double quotientLow;
+    double quotient = exactProduct(s, denominator, quotientLow);
+    double sLow = ((f - quotient) - quotientLow - s * denominatorLow) / denominator;
+    double s2Low;
+    double s2 = exactProduct(s, s, s2Low);
+    s2Low += 2 * s * sLow;
+
+    // atanh(s) = s (1 + s^2 q) with q = 1/3 + s^2/5 + s^4/7 + ..., only 1/3 and the first product need the low parts
+    const double THIRD_HI = 3.33333333333333314830e-01;
+    const double THIRD_LO = 1.85037170770859413132e-17;
+    double rest = s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9 + s2 * (1.0 / 11 + s2 * (1.0 / 13 + s2 * (1.0 / 15 + s2 * (1.0 / 17 + s2 * (1.0 / 19 + s2 * (1.0 / 21 + s2 * (1.0 / 23 + s2 * (1.0 / 25)))))))))));
+    double qLow;
+    double q = exactSum(THIRD_HI, rest, qLow);
+    qLow += THIRD_LO;
+    double seriesLow;
+    double series = exactProduct(s2, q, seriesLow);
+    seriesLow += s2 * qLow + s2Low * q;
+    double termLow;
+    double term = exactProduct(s, series, termLow);
+    termLow += s * seriesLow + sLow * series;
+    double atanhLow;
+    double atanh = exactSum(s, term, atanhLow);
+    atanhLow += sLow + termLow;
+
+    // k * LN2_HI is exact and so is doubling, small terms are collected in the tail
+    double sumLow;
+    double sum = exactSum(k * LN2_HI, 2 * atanh, sumLow);
+    double tail = sumLow + 2 * atanhLow + k * LN2_LO;
+    double high = sum + tail;
+    low = tail - (high - sum);
+    return high;
+}
+
+inline bool isNormalPositive(double x) {
+    return x >= DBL_MIN && x <= DBL_MAX;
+}
+
+template <class Function>
+void fixUnary(const double* slow, double* output, size_t count, Function function) {
+    for (size_t i = 0; i < count; i++) {
+        if (slow[i] != 0) {
+            output[i] = function(output[i]);
+        }
+    }
+}
+
+template <class Function>
+void fixBinary(const double* slow, double* output, const double* second, size_t count, Function function) {
+    for (size_t i = 0; i < count; i++) {
+        if (slow[i] != 0) {
+            output[i] = function(output[i], second[i]);
+        }
+    }
+}
+
+double slowSin(double x) {
+    return std::sin(x);
+}
+
+double slowCos(double x) {
+    return std::cos(x);
+}
+
+double slowTan(double x) {
+    return std::tan(x);
+}
+
+double slowCot(double x) {
+    return 1 / std::tan(x);
+}
+
+double slowExp(double x) {
+    return std::exp(x);
+}
+
+double slowLn(double x) {
+    return std::log(x);
+}
+
+double slowPow(double base, double exponent) {
+    return std::pow(base, exponent);
+}
+
+double slowLog(double base, double value) {
+    return std::log(value) / std::log(base);
+}
+}  // namespace
+
+// Every kernel below follows the same pattern: lanes outside of the fast range keep their
+// input in output and are flagged, then recomputed with the C library after the chunk.
+
+VECTORMATH_DISPATCH
+void sin(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = std::abs(x) <= TRIG_LIMIT;
+            double r;
+            uint64_t quadrant = reduce(fast ? x : 0, r);
+            double s = sinKernel(r);
+            double c = cosKernel(r);
+            double value = selectIf(quadrant, c, s);
+            out[i] = fast ? negateIf(value, quadrant >> 1) : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowSin);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void cos(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = std::abs(x) <= TRIG_LIMIT;
+            double r;
+            // cos(x) = sin(x + pi/2)
+            uint64_t quadrant = reduce(fast ? x : 0, r) + 1;
+            double s = sinKernel(r);
+            double c = cosKernel(r);
+            double value = selectIf(quadrant, c, s);
+            out[i] = fast ? negateIf(value, (quadrant >> 1) & 1) : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowCos);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void tan(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = std::abs(x) <= TRIG_LIMIT;
+            double r;
+            uint64_t quadrant = reduce(fast ? x : 0, r);
+            double s = sinKernel(r);
+            double c = cosKernel(r);
+            double tangent = s / c;
+            double cotangent = -c / s;
+            double value = selectIf(quadrant, cotangent, tangent);
+            out[i] = fast ? value : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowTan);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void cot(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = std::abs(x) <= TRIG_LIMIT;
+            double r;
+            uint64_t quadrant = reduce(fast ? x : 0, r);
+            double s = sinKernel(r);
+            double c = cosKernel(r);
+            double tangent = -s / c;
+            double cotangent = c / s;
+            double value = selectIf(quadrant, tangent, cotangent);
+            out[i] = fast ? value : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowCot);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void exp(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = std::abs(x) <= EXP_LIMIT;
+            double value = expKernel(fast ? x : 0);
+            out[i] = fast ? value : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowExp);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void ln(const double* input, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* in = input + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = in[i];
+            bool fast = isNormalPositive(x);
+            double value = lnKernel(fast ? x : 1);
+            out[i] = fast ? value : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixUnary(slow, out, count, slowLn);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void sqrt(const double* input, double* output, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        output[i] = std::sqrt(input[i]);
+    }
+}
+
+VECTORMATH_DISPATCH
+void abs(const double* input, double* output, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        output[i] = std::abs(input[i]);
+    }
+}
+
+VECTORMATH_DISPATCH
+void sign(const double* input, double* output, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        double x = input[i];
+        output[i] = (double)(0 < x) - (double)(x < 0);
+    }
+}
+
+VECTORMATH_DISPATCH
+void pow(const double* base, const double* exponent, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* a = base + start;
+        const double* b = exponent + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = a[i];
+            double y = b[i];
+
+            // small integer exponents by repeated squaring, used for non positive bases and
+            // for squares, where it is exact
+            bool positive = isNormalPositive(x);
+            double magnitude = std::abs(y);
+            double shifted = magnitude + ROUND_MAGIC;
+            uint64_t n = toBits(shifted);
+            double limit = positive ? 3 : POW_INTEGER_LIMIT;
+            bool integer = shifted - ROUND_MAGIC == magnitude && magnitude < limit;
+            double square = x * x;
+            double power = selectIf(n, x, 1) * selectIf(n >> 1, square, 1) * selectIf(n >> 2, square * square, 1);
+            double inverse = 1 / power;
+            power = y < 0 ? inverse : power;
+
+            // exp(y * ln(x)) for positive x, with the product kept in extended precision
+            double lnLow;
+            double lnHigh = lnKernelExtended(positive ? x : 1, lnLow);
+            double productLow;
+            double product = exactProduct(y, lnHigh, productLow);
+            productLow += y * lnLow;
+            bool fast = positive && std::abs(product) <= EXP_LIMIT;
+            double value = expKernel(fast ? product : 0);
+            value += value * productLow;
+
+            double result = fast ? value : x;
+            out[i] = integer ? power : result;
+            double notFast = fast ? 0 : 1;
+            slow[i] = integer ? 0 : notFast;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixBinary(slow, out, b, count, slowPow);
+        }
+    }
+}
+
+VECTORMATH_DISPATCH
+void log(const double* base, const double* value, double* output, size_t size) {
+    double slow[VECTORMATH_CHUNK];
+    for (size_t start = 0; start < size; start += VECTORMATH_CHUNK) {
+        size_t count = std::min(size - start, (size_t)VECTORMATH_CHUNK);
+        const double* a = base + start;
+        const double* b = value + start;
+        double* out = output + start;
+        double slowCount = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = a[i];
+            double y = b[i];
+            bool fast = isNormalPositive(x) && isNormalPositive(y);
+            double result = lnKernel(fast ? y : 1) / lnKernel(fast ? x : 2);
+            out[i] = fast ? result : x;
+            slow[i] = fast ? 0 : 1;
+            slowCount += slow[i];
+        }
+        if (slowCount != 0) {
+            fixBinary(slow, out, b, count, slowLog);
+        }
+    }
+}
+
+}  // namespace vectormath
+}  // namespace math
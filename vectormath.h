@@ -0,0 +1,39 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+#include <cstddef>
+
+namespace math {
+
+// Double precision math kernels working on whole arrays, used by batch evaluation.
+// Loops are branch free so the compiler vectorizes them (SSE2 baseline); on x86-64 Linux
+// with GCC AVX2 and AVX-512 clones are selected at runtime.
+// Output may alias the first input. Arguments outside of the fast range (huge, non finite,
+// non positive for logarithms, subnormal) are handed to the C library.
+//
+// Maximum error against a correctly rounded result, measured over random sweeps:
+// sin, cos  < 1.5 ulp for |x| < 10, < 2.5 ulp for |x| < 1e5
+// tan, cot  < 3 ulp
+// exp, ln   < 1 ulp
+// log       < 2.5 ulp (ratio of two ln)
+// pow       < 1.5 ulp for positive base, < 6 ulp for negative base and integer exponent
+// sqrt, abs and sign are exact
+namespace vectormath {
+
+void sin(const double* input, double* output, size_t size);
+void cos(const double* input, double* output, size_t size);
+void tan(const double* input, double* output, size_t size);
+void cot(const double* input, double* output, size_t size);
+void exp(const double* input, double* output, size_t size);
+void ln(const double* input, double* output, size_t size);
+void sqrt(const double* input, double* output, size_t size);
+void abs(const double* input, double* output, size_t size);
+void sign(const double* input, double* output, size_t size);
+// output = base ^ exponent
+void pow(const double* base, const double* exponent, double* output, size_t size);
+// output = log_base(value)
+void log(const double* base, const double* value, double* output, size_t size);
+
+}  // namespace vectormath
+}  // namespace math
+
+#endif  // VECTORMATH_H
@@ -2,14 +2,26 @@
 #include "ui_window.h"
 
 #include <QMessageBox>
+#include <QtConcurrent>
 
 #include <cmath>
+#include <limits>
+#include <memory>
+#include "compiledequation.h"
 #include "equationparser.h"
+#include "equationsimplifier.h"
+#include "nodearena.h"
+#include "polynomial.h"
 #include "utils.h"
 
 
 Window::~Window() {
+    solveWatcher->waitForFinished();
     delete ui;
+    delete compiledEquation;
+    delete compiledDerivative;
+    delete polynomial;
+    delete arena;
     view->close();
     delete view;
     delete plotter;
@@ -70,9 +82,14 @@ void Window::initWindow() {
     plotter->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
 
     connect(plotter, SIGNAL(beforeReplot()), this, SLOT(updateGraphs()));
+
+    solveWatcher = new QFutureWatcher<QStringList>(this);
+    connect(solveWatcher, SIGNAL(finished()), this, SLOT(onSolveFinished()));
 }
 
 #define PLOT_REZ 400
+// Largest symbolic derivative plotted, relative to the size of the equation
+#define SYMBOLIC_DERIVATIVE_GROWTH 16
 
 
 void Window::addGraph(bool derivative) {
@@ -110,12 +127,18 @@ void Window::updateGraphs() {
 
 	// generate some points of data (y0 for first, y1 for second graph):
 	QVector<double> x(plotResolution + 1), y0(plotResolution + 1), y1(plotResolution + 1);
-	int lastContinius = 0;
 	for (int i = 0; i <= plotResolution; ++i) {
 	    x[i] = i * xrange.size() / plotResolution + xrange.lower;
-	    y0[i] = equation->evaluate(x[i])->getValue();
-	    y1[i] = derivative->evaluate(x[i])->getValue();
+	}
+	if (compiledDerivative != nullptr) {
+	    compiledEquation->evaluateBatch(x.data(), y0.data(), x.size());
+	    compiledDerivative->evaluateBatch(x.data(), y1.data(), x.size());
+	} else {
+	    compiledEquation->evaluateBatchWithDerivative(x.data(), y0.data(), y1.data(), x.size());
+	}
 
+	int lastContinius = 0;
+	for (int i = 0; i <= plotResolution; ++i) {
 	    if (std::abs(y0[i] - yrange.center()) > 50 && i - lastContinius > 0) {
 		QVector<double> xSegment(i - lastContinius + 1), y0Segment(i - lastContinius + 1), y1Segment(i - lastContinius + 1);
 		for (int j = 0; j <= i - lastContinius; j++) {
@@ -151,13 +174,48 @@ void Window::updateGraphs() {
 }
 // Input and parse function equation
 void Window::on_confirmButton_clicked() {
+    // loading a session may get here while roots of the old equation are still being searched
+    solveWatcher->waitForFinished();
     windowReady = false;
     QString input = ui->equationInput->text();
+    // New trees replace the old ones only if parsing succeeds
+    math::NodeArena* parsedArena = new math::NodeArena();
     try {
-        equation = EquationParser::parseEquation(input.toStdString(), 15);
-        derivative = equation->getDerivative();
+        math::Entry* parsedEquation;
+        math::Entry* parsedDerivative;
+        math::Polynomial* parsedPolynomial;
+        {
+            math::NodeArena::Scope scope(*parsedArena);
+            // share repeated subexpressions, derivative rules copy their operands a lot
+            parsedEquation = parsedArena->intern(EquationParser::parseEquation(input.toStdString(), 15));
+            parsedDerivative = parsedEquation->getDerivative();
+            if (parsedDerivative != nullptr) {
+                parsedDerivative = parsedArena->intern(EquationSimplifier::simplify(parsedDerivative));
+            }
+            parsedPolynomial = math::Polynomial::fromEntry(parsedEquation);
+        }
+        delete compiledEquation;
+        delete compiledDerivative;
+        delete polynomial;
+        delete arena;
+        arena = parsedArena;
+        equation = parsedEquation;
+        derivative = parsedDerivative;
+        polynomial = parsedPolynomial;
+        // the expanded polynomial only guides the root search, expanding products loses digits
+        compiledEquation = new math::CompiledEquation(equation);
+        compiledDerivative = nullptr;
+        if (derivative != nullptr) {
+            compiledDerivative = new math::CompiledEquation(derivative);
+            // derivative plot falls back to automatic differentiation when the symbolic one blows up
+            if (compiledDerivative->instructionCount() > SYMBOLIC_DERIVATIVE_GROWTH * compiledEquation->instructionCount()) {
+                delete compiledDerivative;
+                compiledDerivative = nullptr;
+            }
+        }
         emit tabNameChanged(myIndex, input);
     } catch (std::exception e) {
+        delete parsedArena;
         QMessageBox::warning(this, "Warning", "Error parsing entered equation!\nPlease check your syntax.");
         qDebug() << "Error parsing your input!";
         return;
@@ -171,68 +229,194 @@ void Window::on_confirmButton_clicked() {
 }
 
 void Window::on_solveButton_clicked() {
-    if (windowReady) {
-        double root = 0;
+    if (windowReady && !solveWatcher->isRunning()) {
         try {
             ui->rootList->clear();
             int precision = ui->precision->value();
+            // Digits beyond what double resolves need extended evaluation to get past rounding noise
+            math::Precision evaluation = precision > std::numeric_limits<double>::digits10 ? math::Precision::Extended : math::Precision::Double;
+            // the solve gets its own copy in that precision, plotting keeps reading compiledEquation meanwhile
+            std::shared_ptr<math::CompiledEquation> solveEquation(new math::CompiledEquation(compiledEquation->getSource(), evaluation));
+
+            // Methods run on several threads at once, they only read the equations they use
+            math::CompiledEquation* function = solveEquation.get();
+            EquationSolver::Method method;
+            int tab = ui->tabWidget->currentIndex();
+            switch (tab) {
+                case 0: {
+                    if (ui->autoConstantCB->isChecked()) {
+                        method = [function, precision](double a, double b, double& root, int& iterations) {
+                            return EquationSolver::solveUsingAutoItterations(function, a, b, precision, root, iterations);
+                        };
+                        break;
+                    }
+                    bool fast = ui->fastIterationCB->isChecked();
+                    // combo box entries follow EquationSolver::Acceleration
+                    EquationSolver::Acceleration acceleration = static_cast<EquationSolver::Acceleration>(ui->iterationAcceleration->currentIndex());
+                    int depth = ui->andersonDepth->value();
+                    // arena is owned by the method, so cFunc lives as long as solving does
+                    std::shared_ptr<math::NodeArena> iterationArena(new math::NodeArena());
+                    math::Entry* cFunc;
+                    {
+                        math::NodeArena::Scope scope(*iterationArena);
+                        cFunc = EquationParser::parseEquation(ui->iterationFunctionField->text().toStdString(), 15);
+                    }
+                    method = [function, cFunc, iterationArena, fast, acceleration, depth, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingAcceleratedItterations(function, cFunc, fast, acceleration, depth, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 1: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingNewtonMethod(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 2: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingDichotomy(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 3: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingBrent(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 4: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingSafeNewton(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 5: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingITP(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 6: {
+                    int order = ui->householderOrder->value();
+                    method = [function, order, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingHouseholder(function, order, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 7: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingMultipleRootNewton(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+                case 8: {
+                    method = [function, precision](double a, double b, double& root, int& iterations) {
+                        return EquationSolver::solveUsingMuller(function, a, b, precision, root, iterations);
+                    };
+                    break;
+                }
+            }
+
             QString intervalStr = ui->intervalInput->text();
             math::Interval* userInterval = new math::Interval(intervalStr);
             if (userInterval->size() == 0) {
                 QMessageBox::warning(this, "Warning", "Entered interval is either empty or malformed!");
+                delete userInterval;
                 return;
             }
-            math::Interval* searchInterval;
-            if (ui->doSearchForRoots->isChecked() && ui->searchStep->value() > 0) {
-                int splitIterations = 0;
-                searchInterval = EquationSolver::splitInterval(equation, userInterval, ui->searchStep->value(), splitIterations);
-
-		ui->rootList->addItem(QString::fromStdString("Searching for roots took " + std::to_string(splitIterations) + " itterations"));
-	    } else {
-		searchInterval = userInterval;
-	    }
-	    bool result = false;
-	    int itterations = 0;
-
-	    // Go through each interval and seacrch for roots
-	    for (int i = 0; i < searchInterval->size(); i++) {
-		math::Tuple entry = searchInterval->getAt(i);
-
-		int method = ui->tabWidget->currentIndex();
-		switch (method) {
-		    case 0: {
-			bool fast = ui->fastIterationCB->isChecked();
-			math::Entry* cFunc = EquationParser::parseEquation(ui->iterationFunctionField->text().toStdString(), 15);
-
-			if (fast) {
-			    result = EquationSolver::solveUsingFastItterations(equation, cFunc, entry.a, entry.b, precision, root, itterations);
-			} else {
-			    result = EquationSolver::solveUsingSimpleItterations(equation, cFunc, entry.a, entry.b, precision, root, itterations);
-			}
-			break;
-		    }
-		    case 1: {
-			result = EquationSolver::solveUsingNewtonMethod(equation, derivative, entry.a, entry.b, precision, root, itterations);
-			break;
-		    }
-		    case 2: {
-			result = EquationSolver::solveUsingDichotomy(equation, entry.a, entry.b, precision, root, itterations);
-			break;
-		    }
-		}
 
-		if (result) {
-		    ui->rootList->addItem(QString::fromStdString("Root: x= " + std::to_string(root) + " after " + std::to_string(itterations) + " itterations"));
-		}
-	    }
-	} catch (std::exception e) {
-	    QMessageBox::warning(this, "Warning", "Error parsing entered itteration function!\nPlease check your syntax.");
-	    qDebug() << "Error parsing your input!";
-	    return;
-	}
+            bool search = ui->doSearchForRoots->isChecked() && ui->searchStep->value() > 0;
+            bool verify = search && ui->doVerifyRoots->isChecked();
+            bool muller = tab == 8;
+            double step = ui->searchStep->value();
+            // equation can't change until solving finishes
+            ui->solveButton->setEnabled(false);
+            ui->confirmButton->setEnabled(false);
+            math::Polynomial* polynomialFunction = polynomial;
+            math::CompiledEquation* derivativeFunction = compiledDerivative;
+            solveWatcher->setFuture(QtConcurrent::run([solveEquation, function, derivativeFunction, polynomialFunction, userInterval, method, search, verify, muller, precision, step]() {
+                QStringList lines;
+                std::vector<EquationSolver::Root> roots;
+                std::vector<std::complex<double>> complexRoots;
+                if (verify) {
+                    // every enclosure holds one root, the method only narrows it down
+                    EquationSolver::Verification verification = EquationSolver::verifyRoots(function, derivativeFunction, userInterval, step);
+                    math::Interval enclosures;
+                    enclosures.entries = verification.roots;
+                    roots = EquationSolver::refineRoots(&enclosures, method);
+                    lines << QString::fromStdString("Verified search processed " + std::to_string(verification.boxes) + " boxes");
+                    for (const math::Tuple& region : verification.roots) {
+                        lines << QString::fromStdString("Verified root in [" + std::to_string(region.a) + ", " + std::to_string(region.b) + "]");
+                    }
+                    for (const math::Tuple& region : verification.rootFree) {
+                        lines << QString::fromStdString("No roots in [" + std::to_string(region.a) + ", " + std::to_string(region.b) + "]");
+                    }
+                    for (const math::Tuple& region : verification.undecided) {
+                        lines << QString::fromStdString("Undecided: [" + std::to_string(region.a) + ", " + std::to_string(region.b) + "]");
+                    }
+                } else if (search && polynomialFunction != nullptr) {
+                    // real roots are isolated by Sturm counts and refined with the selected method, Aberth-Ehrlich adds the complex ones
+                    int isolationIterations = 0;
+                    roots = EquationSolver::findPolynomialRealRoots(polynomialFunction, function, userInterval, step, method, precision, isolationIterations);
+                    int sweeps = 0;
+                    complexRoots = EquationSolver::findComplexPolynomialRoots(polynomialFunction, function, precision, sweeps);
+                    lines << QString::fromStdString("Polynomial of degree " + std::to_string(polynomialFunction->degree()) + ", isolating roots took " + std::to_string(isolationIterations) + " itterations");
+                } else if (search) {
+                    int searchIterations = 0;
+                    roots = EquationSolver::findRoots(function, userInterval, step, method, precision, searchIterations);
+                    lines << QString::fromStdString("Searching for roots took " + std::to_string(searchIterations) + " itterations");
+                } else {
+                    roots = EquationSolver::refineRoots(userInterval, method);
+                }
+                if (muller) {
+                    // Muller's method also reaches roots off the real line, one is started from every entered interval
+                    double tolerance = std::pow(10, -precision);
+                    for (int i = 0; i < userInterval->size(); i++) {
+                        math::Tuple entry = userInterval->getAt(i);
+                        std::complex<double> z;
+                        int iterations = 0;
+                        if (!EquationSolver::solveUsingMuller(function, entry.a, entry.b, precision, z, iterations) || std::abs(z.imag()) < tolerance) {
+                            continue;
+                        }
+                        // steps may stall before reaching a root, only ones that bring f below tolerance are listed
+                        if (std::abs(function->calculate(z)) >= tolerance) {
+                            continue;
+                        }
+                        // conjugates are roots too, as every operator is real on the real line
+                        z = std::complex<double>(z.real(), std::abs(z.imag()));
+                        bool known = false;
+                        for (const std::complex<double>& other : complexRoots) {
+                            known = known || std::abs(other - z) < tolerance;
+                        }
+                        if (!known) {
+                            complexRoots.push_back(z);
+                        }
+                    }
+                }
+                delete userInterval;
+
+                for (const EquationSolver::Root& root : roots) {
+                    lines << QString::fromStdString("Root: x= " + std::to_string(root.x) + " after " + std::to_string(root.iterations) + " itterations");
+                }
+                for (const std::complex<double>& root : complexRoots) {
+                    lines << QString::fromStdString("Complex roots: x= " + std::to_string(root.real()) + " ± " + std::to_string(root.imag()) + "i");
+                }
+                return lines;
+            }));
+        } catch (std::exception e) {
+            QMessageBox::warning(this, "Warning", "Error parsing entered itteration function!\nPlease check your syntax.");
+            qDebug() << "Error parsing your input!";
+            return;
+        }
     }
 }
 
+void Window::onSolveFinished() {
+    ui->rootList->addItems(solveWatcher->result());
+    ui->solveButton->setEnabled(true);
+    ui->confirmButton->setEnabled(true);
+}
+
 // handling saving and loading of state
 
 QJsonObject Window::writeToJson() {
@@ -243,11 +427,15 @@ QJsonObject Window::writeToJson() {
     json["interval"] = ui->intervalInput->text();
     json["doSearch"] = ui->doSearchForRoots->isChecked();
     json["searchStep"] = ui->searchStep->value();
+    json["doVerify"] = ui->doVerifyRoots->isChecked();
     json["method"] = ui->tabWidget->currentIndex();
     if (ui->tabWidget->currentIndex() == 0) {
         json["cfunction"] = ui->iterationFunctionField->text();
         bool fast = ui->fastIterationCB->isChecked();
         json["usingFast"] = fast;
+        json["autoConstant"] = ui->autoConstantCB->isChecked();
+        json["acceleration"] = ui->iterationAcceleration->currentIndex();
+        json["andersonDepth"] = ui->andersonDepth->value();
     }
     QJsonArray array;
     for (int i = 0; i < ui->rootList->count(); ++i) {
@@ -265,10 +453,16 @@ void Window::readFromJson(QJsonObject json) {
     ui->intervalInput->setText(json["interval"].toString());
     ui->doSearchForRoots->setChecked(json["doSearch"].toBool());
     ui->searchStep->setValue(json["searchStep"].toDouble());
+    ui->doVerifyRoots->setChecked(json["doVerify"].toBool());
     ui->tabWidget->setCurrentIndex(json["method"].toInt());
     if (json["method"].toInt() == 0) {
         ui->iterationFunctionField->setText(json["cfunction"].toString());
         ui->fastIterationCB->setChecked(json["usingFast"].toBool());
+        ui->autoConstantCB->setChecked(json["autoConstant"].toBool());
+        ui->iterationAcceleration->setCurrentIndex(json["acceleration"].toInt());
+        if (json.contains("andersonDepth")) {
+            ui->andersonDepth->setValue(json["andersonDepth"].toInt());
+        }
     }
     QJsonArray array = json["roots"].toArray();
     for (int i = 0; i < array.size(); ++i) {
@@ -2,6 +2,7 @@
 #define WINDOW_H
 
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QMainWindow>
 #include <QUrl>
 #include <QWidget>
@@ -38,6 +39,9 @@ public slots:
 
     void updateGraphs();
 
+private slots:
+    void onSolveFinished();
+
 signals:
     void tabNameChanged(int index, QString newValue);
 
@@ -47,6 +51,8 @@ private:
     bool hasFunctionGraph;
     bool hasDerivativeGraph;
     int myIndex;
+    // root search running in the background
+    QFutureWatcher<QStringList>* solveWatcher;
 
 private:
     Ui::Window* ui;
@@ -0,0 +1,104 @@
+#include "workstealingpool.h"
+
+#include <algorithm>
+
+namespace {
+// Pool and deque of the worker running on this thread
+thread_local WorkStealingPool* workerPool = nullptr;
+thread_local size_t workerIndex = 0;
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(size_t threadCount) : pending(0), queued(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkStealingPool::work, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAdded.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    size_t index = workerPool == this ? workerIndex : nextQueue++ % queues.size();
+    pending++;
+    {
+        // counted under the deque lock, so a thief taking the task can't decrement first and wrap the counter
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queued++;
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    // taking the lock orders the notify after the predicate check of a worker going to sleep
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    taskAdded.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
+
+size_t WorkStealingPool::threadCount() {
+    return threads.size();
+}
+
+bool WorkStealingPool::take(size_t index, Task& task) {
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t index) {
+    workerPool = this;
+    workerIndex = index;
+    Task task;
+    while (true) {
+        if (take(index, task)) {
+            task();
+            task = nullptr;
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        taskAdded.wait(lock, [this] { return queued > 0 || stopping; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. A worker runs the newest task of its
+// own deque and when that is empty steals the oldest task of another one, so tasks submitted by
+// running tasks stay local until some other worker runs out of work.
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+    // Zero means one thread per hardware thread
+    explicit WorkStealingPool(size_t threadCount = 0);
+    // Waits for all tasks
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Safe to call from tasks, they push to the deque of their own worker
+    void submit(Task task);
+    // Block until every submitted task, including ones submitted by tasks, has finished
+    void wait();
+
+    size_t threadCount();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    // tasks submitted and not finished
+    std::atomic<size_t> pending;
+    // tasks waiting in the deques
+    std::atomic<size_t> queued;
+    std::atomic<size_t> nextQueue;
+    bool stopping;
+    // guards sleeping of idle workers and of wait()
+    std::mutex mutex;
+    std::condition_variable taskAdded;
+    std::condition_variable allDone;
+
+    bool take(size_t index, Task& task);
+    void work(size_t index);
+};
+
+#endif  // WORKSTEALINGPOOL_H